@@ -8,25 +8,125 @@
 
 #include "chip8.h"
 #include <cstring>
-#include <iostream>
 #include <fstream>
+#include <vector>
 
-Chip8::Chip8()
+template <class Access, class Quirks>
+const unsigned char Chip8Core<Access, Quirks>::fontset[80] =
+{
+	0xF0, 0x90, 0x90, 0x90, 0xF0, // 0
+	0x20, 0x60, 0x20, 0x20, 0x70, // 1
+	0xF0, 0x10, 0xF0, 0x80, 0xF0, // 2
+	0xF0, 0x10, 0xF0, 0x10, 0xF0, // 3
+	0x90, 0x90, 0xF0, 0x10, 0x10, // 4
+	0xF0, 0x80, 0xF0, 0x10, 0xF0, // 5
+	0xF0, 0x80, 0xF0, 0x90, 0xF0, // 6
+	0xF0, 0x10, 0x20, 0x40, 0x40, // 7
+	0xF0, 0x90, 0xF0, 0x90, 0xF0, // 8
+	0xF0, 0x90, 0xF0, 0x10, 0xF0, // 9
+	0xF0, 0x90, 0xF0, 0x90, 0x90, // A
+	0xE0, 0x90, 0xE0, 0x90, 0xE0, // B
+	0xF0, 0x80, 0x80, 0x80, 0xF0, // C
+	0xE0, 0x90, 0x90, 0x90, 0xE0, // D
+	0xF0, 0x80, 0xF0, 0x80, 0xF0, // E
+	0xF0, 0x80, 0xF0, 0x80, 0x80  // F
+};
+
+template <class Access, class Quirks>
+const unsigned char Chip8Core<Access, Quirks>::bigFontset[160] =
+{
+	0x3C, 0x7E, 0xE7, 0xC3, 0xC3, 0xC3, 0xC3, 0xE7, 0x7E, 0x3C, // 0
+	0x18, 0x38, 0x58, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x3C, // 1
+	0x3E, 0x7F, 0xC3, 0x06, 0x0C, 0x18, 0x30, 0x60, 0xFF, 0xFF, // 2
+	0x3C, 0x7E, 0xC3, 0x03, 0x0E, 0x0E, 0x03, 0xC3, 0x7E, 0x3C, // 3
+	0x06, 0x0E, 0x1E, 0x36, 0x66, 0xC6, 0xFF, 0xFF, 0x06, 0x06, // 4
+	0xFF, 0xFF, 0xC0, 0xC0, 0xFC, 0xFE, 0x03, 0xC3, 0x7E, 0x3C, // 5
+	0x3E, 0x7C, 0xC0, 0xC0, 0xFC, 0xFE, 0xC3, 0xC3, 0x7E, 0x3C, // 6
+	0xFF, 0xFF, 0x03, 0x06, 0x0C, 0x18, 0x30, 0x60, 0x60, 0x60, // 7
+	0x3C, 0x7E, 0xC3, 0xC3, 0x7E, 0x7E, 0xC3, 0xC3, 0x7E, 0x3C, // 8
+	0x3C, 0x7E, 0xC3, 0xC3, 0x7F, 0x3F, 0x03, 0x03, 0x3E, 0x7C, // 9
+	0x7E, 0xFF, 0xC3, 0xC3, 0xC3, 0xFF, 0xFF, 0xC3, 0xC3, 0xC3, // A
+	0xFC, 0xFC, 0xC3, 0xC3, 0xFC, 0xFC, 0xC3, 0xC3, 0xFC, 0xFC, // B
+	0x3C, 0xFF, 0xC3, 0xC0, 0xC0, 0xC0, 0xC0, 0xC3, 0xFF, 0x3C, // C
+	0xFC, 0xFE, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xFE, 0xFC, // D
+	0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, // E
+	0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0xC0, 0xC0, 0xC0, 0xC0  // F
+};
+
+// Decode table for the emulator opcodes
+template <class Access, class Quirks>
+void (Chip8Core<Access, Quirks>::* const Chip8Core<Access, Quirks>::decodeTable[16])() =
+{
+	&Chip8Core::decodeOpcode0, &Chip8Core::jumpToAddress,
+	&Chip8Core::callSubroutine, &Chip8Core::skipInstructionIfEqualsN,
+	&Chip8Core::skipInstructionIfNotEqualsN, &Chip8Core::decodeOpcode5,
+	&Chip8Core::setToN, &Chip8Core::AddN,
+	&Chip8Core::decodeOpcode8, &Chip8Core::skipInstructionIfNotEquals,
+	&Chip8Core::setI, &Chip8Core::jumpToAddressPlus,
+	&Chip8Core::setRandom, &Chip8Core::drawSprite,
+	&Chip8Core::decodeOpcodeE, &Chip8Core::decodeOpcodeF
+};
+
+// Decode table for opcodes 8xxx
+template <class Access, class Quirks>
+void (Chip8Core<Access, Quirks>::* const Chip8Core<Access, Quirks>::opcode8DecodeTable[9])() =
+{
+	&Chip8Core::assign, &Chip8Core::bitwiseOr, &Chip8Core::bitwiseAnd, &Chip8Core::bitwiseXor,
+	&Chip8Core::add, &Chip8Core::subtract, &Chip8Core::bitwiseShiftRight,
+	&Chip8Core::reverseSubtract, &Chip8Core::bitwiseShiftLeft
+};
+
+// Decode table for opcodes Exxx
+template <class Access, class Quirks>
+void (Chip8Core<Access, Quirks>::* const Chip8Core<Access, Quirks>::opcodeEDecodeTable[2])() =
+{
+	&Chip8Core::skipIfKeyPressed, &Chip8Core::skipIfKeyNotPressed
+};
+
+// Memory with the fontsets loaded
+static Chip8PageTable<Chip8::XO_MEMORY_SIZE / Chip8Page::SIZE> createInitialMemory()
+{
+	Chip8PageTable<Chip8::XO_MEMORY_SIZE / Chip8Page::SIZE> memory;
+	memory.Write(0, Chip8::fontset, 80);
+	memory.Write(80, Chip8::bigFontset, 160);
+	return memory;
+}
+
+// Memory after initialization, shared by every instance until it writes to
+// the font page
+static const Chip8PageTable<Chip8::XO_MEMORY_SIZE / Chip8Page::SIZE> &initialMemory()
+{
+	static const Chip8PageTable<Chip8::XO_MEMORY_SIZE / Chip8Page::SIZE> memory = createInitialMemory();
+	return memory;
+}
+
+template <class Access, class Quirks>
+Chip8Core<Access, Quirks>::Chip8Core() : xoChip(false), events(nullptr)
 {
 	init();
 }
 
-Chip8::~Chip8()
+template <class Access, class Quirks>
+Chip8Core<Access, Quirks>::~Chip8Core()
 {
 }
 
 // Initializes the Chip-8 Emulator
-void Chip8::init()
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::init()
 {
-	// Reset memory, registers, screen and keys
-	memset(memory, 0, 4096);
+	// Reset memory (with the fontsets loaded), registers, screen and keys
+	memory = initialMemory();
+	memorySize = xoChip ? XO_MEMORY_SIZE : MEMORY_SIZE;
 	memset(V, 0, 16);
-	memset(screen, 0, 64 * 32);
+	memset(stack, 0, sizeof(stack));
+	for (unsigned int i = 0; i < PLANE_COUNT; i++)
+	{
+		screen[i].Clear();
+	}
+	planes = 1;
+	hires = false;
+	memset(flags, 0, 16);
 	memset(keys, 0, 16);
 
 	pc = 0x200;
@@ -35,122 +135,350 @@ void Chip8::init()
 	sp = 0;
 	delay_timer = 0;
 	sound_timer = 0;
-	soundEnabled = true;
+	codeModified = false;
+	fault = Chip8Fault::None;
+	faultPc = 0;
+	cycleCount = 0;
+
+	// Until an application loads a pattern, the sound timer plays the beeper
+	memset(audioPattern, 0, 16);
+	pitch = 64;
+}
 
-	// Load the fontset
-	memcpy(memory, fontset, 80);
+// Enables or disables the XO-CHIP extensions and resets the emulator
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::SetXoChip(bool xoChip)
+{
+	this->xoChip = xoChip;
+	init();
 }
 
 // Decodes the opcode 0xxx.
-void Chip8::decodeOpcode0()
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::decodeOpcode0()
+{
+	if ((opcode & 0xFFF0) == 0x00C0)
+	{
+		scrollDown();
+		return;
+	}
+	if ((opcode & 0xFFF0) == 0x00D0 && xoChip)
+	{
+		scrollUp();
+		return;
+	}
+
+	switch (opcode)
+	{
+	case 0x00E0:
+		clearScreen();
+		break;
+	case 0x00EE:
+		returnFromSubroutine();
+		break;
+	case 0x00FB:
+		scrollRight();
+		break;
+	case 0x00FC:
+		scrollLeft();
+		break;
+	case 0x00FE:
+		lowResolution();
+		break;
+	case 0x00FF:
+		highResolution();
+		break;
+	default:
+		illegalOpcode();
+		break;
+	}
+}
+
+// 00CN - Scrolls the selected planes down by N rows.
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::scrollDown()
 {
-	(this->*(opcode0DecodeTable[(opcode & 0x0002) >> 1]))();
+	for (unsigned int i = 0; i < PLANE_COUNT; i++)
+	{
+		if ((planes & (1 << i)) != 0)
+		{
+			screen[i].ScrollDown(opcode & 0x000F, GetScreenHeight());
+		}
+	}
 }
 
-// 00E0 - Clears the screen.
-void Chip8::clearScreen()
+// 00DN - Scrolls the selected planes up by N rows.
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::scrollUp()
 {
-	memset(screen, 0, 64 * 32);
+	for (unsigned int i = 0; i < PLANE_COUNT; i++)
+	{
+		if ((planes & (1 << i)) != 0)
+		{
+			screen[i].ScrollUp(opcode & 0x000F, GetScreenHeight());
+		}
+	}
+}
+
+// 00E0 - Clears the selected planes.
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::clearScreen()
+{
+	for (unsigned int i = 0; i < PLANE_COUNT; i++)
+	{
+		if ((planes & (1 << i)) != 0)
+		{
+			screen[i].Clear();
+		}
+	}
 }
 
 // 00EE - Returns from a subroutine.
-void Chip8::returnFromSubroutine()
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::returnFromSubroutine()
+{
+	unsigned int slot = Access::Pop(sp, STACK_SIZE, fault);
+	pc = stack[slot];
+	sp = slot;
+}
+
+// 00FB - Scrolls the selected planes right by 4 columns.
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::scrollRight()
+{
+	for (unsigned int i = 0; i < PLANE_COUNT; i++)
+	{
+		if ((planes & (1 << i)) != 0)
+		{
+			screen[i].ScrollRight(4, GetScreenWidth(), GetScreenHeight());
+		}
+	}
+}
+
+// 00FC - Scrolls the selected planes left by 4 columns.
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::scrollLeft()
+{
+	for (unsigned int i = 0; i < PLANE_COUNT; i++)
+	{
+		if ((planes & (1 << i)) != 0)
+		{
+			screen[i].ScrollLeft(4, GetScreenWidth(), GetScreenHeight());
+		}
+	}
+}
+
+// 00FE - Switches to the 64x32 screen. Every plane is cleared, since the
+//        two resolutions don't share any pixels.
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::lowResolution()
 {
-	pc = stack[--sp];
+	hires = false;
+	for (unsigned int i = 0; i < PLANE_COUNT; i++)
+	{
+		screen[i].Clear();
+	}
+}
+
+// 00FF - Switches to the 128x64 screen.
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::highResolution()
+{
+	hires = true;
+	for (unsigned int i = 0; i < PLANE_COUNT; i++)
+	{
+		screen[i].Clear();
+	}
 }
 
 // 1NNN - Jumps to address NNN.
-void Chip8::jumpToAddress()
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::jumpToAddress()
 {
 	pc = (opcode & 0x0FFF) - 2;
 }
 
 // 2NNN - Calls subroutine at NNN.
-void Chip8::callSubroutine()
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::callSubroutine()
 {
-	stack[sp++] = pc;
+	unsigned int slot = Access::Push(sp, STACK_SIZE, fault);
+	stack[slot] = pc;
+	sp = slot + 1;
 	pc = (opcode & 0x0FFF) - 2;
 }
 
 // 3XNN - Skips the next instruction if VX equals NN.
-void Chip8::skipInstructionIfEqualsN()
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::skipInstructionIfEqualsN()
 {
 	if (V[(opcode & 0x0F00) >> 8] == (opcode & 0x00FF))
 	{
-		pc += 2;
+		skipInstruction();
 	}
 }
 
 // 4XNN - Skips the next instruction if VX doesn't equal NN.
-void Chip8::skipInstructionIfNotEqualsN()
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::skipInstructionIfNotEqualsN()
 {
 	if (V[(opcode & 0x0F00) >> 8] != (opcode & 0x00FF))
 	{
-		pc += 2;
+		skipInstruction();
+	}
+}
+
+// Decodes the opcode 5xxx.
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::decodeOpcode5()
+{
+	switch (opcode & 0x000F)
+	{
+	case 0x0000:
+		skipInstructionIfEquals();
+		break;
+	case 0x0002:
+		if (xoChip)
+		{
+			saveRange();
+		}
+		else
+		{
+			illegalOpcode();
+		}
+		break;
+	case 0x0003:
+		if (xoChip)
+		{
+			loadRange();
+		}
+		else
+		{
+			illegalOpcode();
+		}
+		break;
+	default:
+		illegalOpcode();
+		break;
 	}
 }
 
 // 5XY0 - Skips the next instruction if VX equals VY.
-void Chip8::skipInstructionIfEquals()
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::skipInstructionIfEquals()
 {
 	if (V[(opcode & 0x0F00) >> 8] == V[(opcode & 0x00F0) >> 4])
 	{
-		pc += 2;
+		skipInstruction();
+	}
+}
+
+// 5XY2 - Stores VX to VY (including VY) in memory starting at address I.
+//        If X is greater than Y, the registers are stored in reverse order.
+//        I is left unchanged.
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::saveRange()
+{
+	unsigned int x = (opcode & 0x0F00) >> 8;
+	unsigned int y = (opcode & 0x00F0) >> 4;
+	unsigned int count = ((x < y) ? y - x : x - y) + 1;
+	for (unsigned int i = 0; i < count; i++)
+	{
+		memory.Set(Access::Memory(I + i, memorySize, fault), V[(x < y) ? x + i : x - i]);
+	}
+}
+
+// 5XY3 - Fills VX to VY (including VY) with values from memory starting at
+//        address I. If X is greater than Y, the registers are loaded in
+//        reverse order. I is left unchanged.
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::loadRange()
+{
+	unsigned int x = (opcode & 0x0F00) >> 8;
+	unsigned int y = (opcode & 0x00F0) >> 4;
+	unsigned int count = ((x < y) ? y - x : x - y) + 1;
+	for (unsigned int i = 0; i < count; i++)
+	{
+		V[(x < y) ? x + i : x - i] = memory.Get(Access::Memory(I + i, memorySize, fault));
 	}
 }
 
 // 6XNN - Sets VX to NN.
-void Chip8::setToN()
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::setToN()
 {
 	V[(opcode & 0x0F00) >> 8] = opcode & 0x00FF;
 }
 
 // 7XNN - Adds NN to VX.
-void Chip8::AddN()
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::AddN()
 {
 	V[(opcode & 0x0F00) >> 8] += opcode & 0x00FF;
 }
 
 // Decodes the opcode 8xxx.
-void Chip8::decodeOpcode8()
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::decodeOpcode8()
 {
 	if ((opcode & 0x0008) == 0)
 	{
 		(this->*(opcode8DecodeTable[opcode & 0x0007]))();
 	}
-	else
+	else if ((opcode & 0x000F) == 0x000E)
 	{
 		(this->*(opcode8DecodeTable[8]))();
 	}
+	else
+	{
+		illegalOpcode();
+	}
 }
 
 // 8XY0 - Sets VX to the value of VY.
-void Chip8::assign()
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::assign()
 {
 	V[(opcode & 0x0F00) >> 8] = V[(opcode & 0x00F0) >> 4];
 }
 
 // 8XY1 - Sets VX to VX or VY (Bitwise OR operation).
-void Chip8::bitwiseOr()
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::bitwiseOr()
 {
 	V[(opcode & 0x0F00) >> 8] |= V[(opcode & 0x00F0) >> 4];
+	if (Quirks::LOGIC_RESETS_VF)
+	{
+		V[0xF] = 0;
+	}
 }
 
 // 8XY2 - Sets VX to VX and VY (Bitwise AND operation).
-void Chip8::bitwiseAnd()
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::bitwiseAnd()
 {
 	V[(opcode & 0x0F00) >> 8] &= V[(opcode & 0x00F0) >> 4];
+	if (Quirks::LOGIC_RESETS_VF)
+	{
+		V[0xF] = 0;
+	}
 }
 
 // 8XY3 - Sets VX to VX xor VY (Bitwise XOR operation).
-void Chip8::bitwiseXor()
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::bitwiseXor()
 {
 	V[(opcode & 0x0F00) >> 8] ^= V[(opcode & 0x00F0) >> 4];
+	if (Quirks::LOGIC_RESETS_VF)
+	{
+		V[0xF] = 0;
+	}
 }
 
 // 8XY4 - Adds VY to VX. VF is set to 1 when there's a carry,
 //        and to 0 when there isn't.
-void Chip8::add()
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::add()
 {
 	V[0xF] = (V[(opcode & 0x0F00) >> 8] + V[(opcode & 0x00F0) >> 4]) >> 8;
 	V[(opcode & 0x0F00) >> 8] += V[(opcode & 0x00F0) >> 4];
@@ -158,59 +486,78 @@ void Chip8::add()
 
 // 8XY5 - VY is subtracted from VX. VF is set to 0 when there's a borrow,
 //        and 1 when there isn't.
-void Chip8::subtract()
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::subtract()
 {
 	V[0xF] = (V[(opcode & 0x0F00) >> 8] >= V[(opcode & 0x00F0) >> 4]);
 	V[(opcode & 0x0F00) >> 8] -= V[(opcode & 0x00F0) >> 4];
 }
 
 // 8XY6 - Shifts VX right by one. VF is set to the value of the least
-//        significant bit of VX before the shift.
-void Chip8::bitwiseShiftRight()
+//        significant bit of VX before the shift. With SHIFT_FLAG_FIRST,
+//        VX is shifted after VF was written, so 8F06 shifts the flag.
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::bitwiseShiftRight()
 {
-	V[0xF] = V[(opcode & 0x0F00) >> 8] & 0x0001;
-	V[(opcode & 0x0F00) >> 8] >>= 1;
+	unsigned int x = (opcode & 0x0F00) >> 8;
+	unsigned char source = V[Quirks::SHIFT_USES_VY ? (opcode & 0x00F0) >> 4 : x];
+	V[0xF] = source & 0x0001;
+	V[x] = (Quirks::SHIFT_FLAG_FIRST ? V[x] : source) >> 1;
 }
 
 // 8XY7 - Sets VX to VY minus VX. VF is set to 0 when there's a borrow,
 //        and 1 when there isn't.
-void Chip8::reverseSubtract()
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::reverseSubtract()
 {
 	V[0xF] = (V[(opcode & 0x0F00) >> 8] <= V[(opcode & 0x00F0) >> 4]);
 	V[(opcode & 0x0F00) >> 8] = V[(opcode & 0x00F0) >> 4] - V[(opcode & 0x0F00) >> 8];
 }
 
 // 8XYE - Shifts VX left by one. VF is set to the value of the most
-//        significant bit of VX before the shift.
-void Chip8::bitwiseShiftLeft()
+//        significant bit of VX before the shift. With SHIFT_FLAG_FIRST,
+//        VX is shifted after VF was written, so 8F0E shifts the flag.
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::bitwiseShiftLeft()
 {
-	V[0xF] = V[(opcode & 0x0F00) >> 8] >> 7;
-	V[(opcode & 0x0F00) >> 8] <<= 1;
+	unsigned int x = (opcode & 0x0F00) >> 8;
+	unsigned char source = V[Quirks::SHIFT_USES_VY ? (opcode & 0x00F0) >> 4 : x];
+	V[0xF] = source >> 7;
+	V[x] = (Quirks::SHIFT_FLAG_FIRST ? V[x] : source) << 1;
 }
 
 // 9XY0 - Skips the next instruction if VX doesn't equal VY.
-void Chip8::skipInstructionIfNotEquals()
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::skipInstructionIfNotEquals()
 {
-	if (V[(opcode & 0x0F00) >> 8] != V[(opcode & 0x00F0) >> 4])
+	if ((opcode & 0x000F) != 0)
 	{
-		pc += 2;
+		illegalOpcode();
+	}
+	else if (V[(opcode & 0x0F00) >> 8] != V[(opcode & 0x00F0) >> 4])
+	{
+		skipInstruction();
 	}
 }
 
 // ANNN - Sets I to the address NNN.
-void Chip8::setI()
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::setI()
 {
 	I = opcode & 0x0FFF;
 }
 
 // BNNN - Jumps to the address NNN plus V0.
-void Chip8::jumpToAddressPlus()
+// BXNN - Jumps to the address XNN plus VX (quirk).
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::jumpToAddressPlus()
 {
-	pc = (opcode & 0x0FFF) + V[0] - 2;
+	pc = (opcode & 0x0FFF) + V[Quirks::JUMP_USES_VX ? (opcode & 0x0F00) >> 8 : 0] - 2;
 }
 
 // CXNN - Sets VX to the result of a bitwise and operation on a random number (0 to 255) and NN.
-void Chip8::setRandom()
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::setRandom()
 {
 	V[(opcode & 0x0F00) >> 8] = rand() & opcode & 0x00FF;
 }
@@ -220,61 +567,186 @@ void Chip8::setRandom()
 //        I value doesnt change after the execution of this instruction. As described above,
 //        VF is set to 1 if any screen pixels are flipped from set to unset when the sprite is drawn,
 //        and to 0 if that doesnt happen.
-void Chip8::drawSprite()
+//        DXY0 draws a 16x16 sprite. With two planes selected, the sprite
+//        data of the second plane follows the data of the first.
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::drawSprite()
 {
 	unsigned char N  = opcode & 0x000F;
 	unsigned char x = V[(opcode & 0x0F00) >> 8];
 	unsigned char y = V[(opcode & 0x00F0) >> 4];
 
+	// DXY0 draws 16 rows of two bytes each
+	unsigned int rows = (N == 0) ? 16 : N;
+	unsigned int columns = (N == 0) ? 16 : 8;
+
 	V[0xF] = 0;
-	for (int i = 0; i < N; i++)
+	unsigned int address = I;
+	for (unsigned int i = 0; i < PLANE_COUNT; i++)
 	{
-		unsigned char row = memory[I + i];
-		for (int j = 0; j < 8; j++)
+		if ((planes & (1 << i)) != 0)
 		{
-			if ((row & (0x80 >> j)) != 0)
+			if (drawPlane(screen[i], address, x, y, rows, columns))
 			{
-				if (screen[64 * (y + i) + x + j] == 1)
+				V[0xF] = 1;
+			}
+			address += rows * columns / 8;
+		}
+	}
+
+	raise(Chip8EventType::Draw, x | y << 8 | N << 16 | V[0xF] << 24, cycleCount);
+}
+
+// Draws sprite data into one plane. Returns whether a set pixel was cleared.
+// With the CLIP_SPRITES quirk, the sprite starts at the wrapped position and
+// is cut off at the edges of the screen. Otherwise the access policy decides
+// about the pixels past an edge, one run of pixels at a time.
+template <class Access, class Quirks>
+bool Chip8Core<Access, Quirks>::drawPlane(Chip8Screen &plane, unsigned int address, unsigned int x, unsigned int y, unsigned int rows, unsigned int columns)
+{
+	unsigned int width = GetScreenWidth();
+	unsigned int height = GetScreenHeight();
+	if (Quirks::CLIP_SPRITES)
+	{
+		x &= width - 1;
+		y &= height - 1;
+	}
+
+	bool collision = false;
+	for (unsigned int i = 0; i < rows; i++)
+	{
+		if (Quirks::CLIP_SPRITES && y + i >= height)
+		{
+			break;
+		}
+
+		unsigned int row = memory.Get(Access::Memory(address + i * columns / 8, memorySize, fault));
+		if (columns == 16)
+		{
+			row = row << 8 | memory.Get(Access::Memory(address + 2 * i + 1, memorySize, fault));
+		}
+
+		if (Quirks::CLIP_SPRITES)
+		{
+			// Columns past the right edge are cut off
+			unsigned int visible = (x + columns <= width) ? columns : width - x;
+			if (plane.Draw(x, y + i, row >> (columns - visible), visible))
+			{
+				collision = true;
+			}
+			continue;
+		}
+
+		if (x + columns <= width && y + i < height)
+		{
+			// The whole row is on the screen
+			if (plane.Draw(x, y + i, row, columns))
+			{
+				collision = true;
+			}
+			continue;
+		}
+
+		// The row crosses an edge of the screen. It is split where it crosses
+		// a multiple of the width, which leaves at most two runs that every
+		// policy keeps or moves as a whole, so it only decides about the
+		// first pixel of each run.
+		for (unsigned int start = 0; start < columns; )
+		{
+			unsigned int px = x + start;
+			unsigned int py = y + i;
+			unsigned int length = ((px | (width - 1)) + 1) - px;
+			if (length > columns - start)
+			{
+				length = columns - start;
+			}
+
+			unsigned int bits = (row >> (columns - start - length)) & ((1 << length) - 1);
+			if (bits != 0 && Access::Pixel(px, py, width, height, fault))
+			{
+				if (plane.Draw(px, py, bits, length))
 				{
-					V[0xF] = 1;
+					collision = true;
 				}
-				screen[64 * (y + i) + x + j] ^= 1;
 			}
+			start += length;
 		}
 	}
+	return collision;
 }
 
 // Decodes the opcode Exxx.
-void Chip8::decodeOpcodeE()
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::decodeOpcodeE()
 {
-	(this->*(opcodeEDecodeTable[opcode & 0x0001]))();
+	if ((opcode & 0x00FF) == 0x009E || (opcode & 0x00FF) == 0x00A1)
+	{
+		(this->*(opcodeEDecodeTable[opcode & 0x0001]))();
+	}
+	else
+	{
+		illegalOpcode();
+	}
 }
 
 // EX9E - Skips the next instruction if the key stored in VX is pressed.
 //        (Usually the next instruction is a jump to skip a code block)
-void Chip8::skipIfKeyPressed()
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::skipIfKeyPressed()
 {
-	if (keys[V[(opcode & 0x0F00) >> 8]] == 1)
+	if (keys[V[(opcode & 0x0F00) >> 8] & 0x0F] == 1)
 	{
-		pc += 2;
+		skipInstruction();
 	}
 }
 
 // EXA1 - Skips the next instruction if the key stored in VX isn't pressed.
 //        (Usually the next instruction is a jump to skip a code block)
-void Chip8::skipIfKeyNotPressed()
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::skipIfKeyNotPressed()
 {
-	if (keys[V[(opcode & 0x0F00) >> 8]] == 0)
+	if (keys[V[(opcode & 0x0F00) >> 8] & 0x0F] == 0)
 	{
-		pc += 2;
+		skipInstruction();
 	}
 }
 
 // Decodes the opcode Fxxx.
-void Chip8::decodeOpcodeF()
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::decodeOpcodeF()
 {
 	switch (opcode & 0x00FF)
 	{
+	case 0x0000:
+		if (opcode == 0xF000 && xoChip)
+		{
+			setLongI();
+		}
+		else
+		{
+			illegalOpcode();
+		}
+		break;
+	case 0x0001:
+		if (xoChip && (opcode & 0x0F00) <= 0x0300)
+		{
+			selectPlanes();
+		}
+		else
+		{
+			illegalOpcode();
+		}
+		break;
+	case 0x0002:
+		if (xoChip && (opcode & 0x0F00) == 0)
+		{
+			loadAudioPattern();
+		}
+		else
+		{
+			illegalOpcode();
+		}
+		break;
 	case 0x0007:
 		getDelay();
 		break;
@@ -290,9 +762,22 @@ void Chip8::decodeOpcodeF()
 	case 0x001E:
 		addToI();
 		break;
+	case 0x003A:
+		if (xoChip)
+		{
+			setPitch();
+		}
+		else
+		{
+			illegalOpcode();
+		}
+		break;
 	case 0x0029:
 		findCharacter();
 		break;
+	case 0x0030:
+		findBigCharacter();
+		break;
 	case 0x0033:
 		setBCD();
 		break;
@@ -302,18 +787,45 @@ void Chip8::decodeOpcodeF()
 	case 0x0065:
 		loadRegisters();
 		break;
+	case 0x0075:
+		storeFlags();
+		break;
+	case 0x0085:
+		loadFlags();
+		break;
+	default:
+		illegalOpcode();
+		break;
 	}
 }
 
+// F000 NNNN - Sets I to the 16-bit address NNNN stored after the opcode.
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::setLongI()
+{
+	I = memory.Get(Access::Memory(pc + 2, memorySize, fault)) << 8 | memory.Get(Access::Memory(pc + 3, memorySize, fault));
+	pc += 2;
+}
+
+// FN01 - Selects the planes drawn to by N (bit i selects plane i). Clearing
+//        and scrolling only affect the selected planes as well.
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::selectPlanes()
+{
+	planes = (opcode & 0x0F00) >> 8;
+}
+
 // FX07 - Sets VX to the value of the delay timer.
-void Chip8::getDelay()
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::getDelay()
 {
 	V[(opcode & 0x0F00) >> 8] = delay_timer;
 }
 
 // FX0A - A key press is awaited, and then stored in VX.
 //        (Blocking Operation. All instruction halted until next key event)
-void Chip8::getKey()
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::getKey()
 {
 	bool keyPressed = false;
 	for (int i = 0; i < 16; i++)
@@ -332,19 +844,48 @@ void Chip8::getKey()
 }
 
 // FX15 - Sets the delay timer to VX.
-void Chip8::setDelay()
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::setDelay()
 {
 	delay_timer = V[(opcode & 0x0F00) >> 8];
 }
 
 // FX18 - Sets the sound timer to VX.
-void Chip8::setSound()
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::setSound()
+{
+	unsigned char value = V[(opcode & 0x0F00) >> 8];
+	if ((sound_timer == 0) != (value == 0))
+	{
+		raise((value != 0) ? Chip8EventType::SoundStart : Chip8EventType::SoundStop, 0, cycleCount);
+	}
+	sound_timer = value;
+}
+
+// F002 - Loads 16 bytes starting at I into the audio pattern buffer. The
+//        pattern is played one bit per sample while the sound timer runs.
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::loadAudioPattern()
+{
+	for (unsigned int i = 0; i < 16; i++)
+	{
+		audioPattern[i] = memory.Get(Access::Memory(I + i, memorySize, fault));
+	}
+	raise(Chip8EventType::AudioPattern, 0, cycleCount, audioPattern);
+}
+
+// FX3A - Sets the pitch register to VX. The pattern plays at
+//        4000 * 2^((pitch - 64) / 48) samples per second.
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::setPitch()
 {
-	sound_timer = V[(opcode & 0x0F00) >> 8];
+	pitch = V[(opcode & 0x0F00) >> 8];
+	raise(Chip8EventType::AudioPitch, pitch, cycleCount);
 }
 
 // FX1E - Adds VX to I.
-void Chip8::addToI()
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::addToI()
 {
 	V[0xF] = (I + V[(opcode & 0x0F00) >> 8]) >> 16;
 	I += V[(opcode & 0x0F00) >> 8];
@@ -352,94 +893,246 @@ void Chip8::addToI()
 
 // FX29 - Sets I to the location of the sprite for the character in VX.
 //        Characters 0-F (in hexadecimal) are represented by a 4x5 font.
-void Chip8::findCharacter()
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::findCharacter()
 {
 	I = (V[(opcode & 0x0F00) >> 8] & 0x0F) * 5;
 }
 
+// FX30 - Sets I to the location of the 8x10 sprite for the character in VX.
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::findBigCharacter()
+{
+	I = 80 + (V[(opcode & 0x0F00) >> 8] & 0x0F) * 10;
+}
+
 // FX33 - Stores the binary-coded decimal representation of VX, with the most
 //        significant of three digits at the address in I, the middle digit at
 //        I plus 1, and the least significant digit at I plus 2.
 //        (In other words, take the decimal representation of VX, place the
 //        hundreds digit in memory at location in I, the tens digit at location I+1,
 //        and the ones digit at location I+2.)
-void Chip8::setBCD()
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::setBCD()
 {
-	memory[I]     = V[(opcode & 0x0F00) >> 8] / 100;
-	memory[I + 1] = (V[(opcode & 0x0F00) >> 8] % 100) / 10;
-	memory[I + 2] = V[(opcode & 0x0F00) >> 8] % 10;
+	memory.Set(Access::Memory(I,     memorySize, fault), V[(opcode & 0x0F00) >> 8] / 100);
+	memory.Set(Access::Memory(I + 1, memorySize, fault), (V[(opcode & 0x0F00) >> 8] % 100) / 10);
+	memory.Set(Access::Memory(I + 2, memorySize, fault), V[(opcode & 0x0F00) >> 8] % 10);
 }
 
 // FX55 - Stores V0 to VX (including VX) in memory starting at address I.
-void Chip8::storeRegisters()
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::storeRegisters()
 {
-	memcpy(memory + I, V, ((opcode & 0x0F00) >> 8) + 1);
+	for (unsigned int i = 0; i <= ((opcode & 0x0F00) >> 8); i++)
+	{
+		memory.Set(Access::Memory(I + i, memorySize, fault), V[i]);
+	}
+	if (Quirks::LOAD_STORE_INCREMENTS_I)
+	{
+		I += ((opcode & 0x0F00) >> 8) + 1;
+	}
 }
 
 // FX65 - Fills V0 to VX (including VX) with values from memory starting at address I.
-void Chip8::loadRegisters()
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::loadRegisters()
 {
-	memcpy(V, memory + I, ((opcode & 0x0F00) >> 8) + 1);
+	for (unsigned int i = 0; i <= ((opcode & 0x0F00) >> 8); i++)
+	{
+		V[i] = memory.Get(Access::Memory(I + i, memorySize, fault));
+	}
+	if (Quirks::LOAD_STORE_INCREMENTS_I)
+	{
+		I += ((opcode & 0x0F00) >> 8) + 1;
+	}
+}
+
+// FX75 - Stores V0 to VX (including VX) in the user flags.
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::storeFlags()
+{
+	memcpy(flags, V, ((opcode & 0x0F00) >> 8) + 1);
+}
+
+// FX85 - Fills V0 to VX (including VX) with values from the user flags.
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::loadFlags()
+{
+	memcpy(V, flags, ((opcode & 0x0F00) >> 8) + 1);
 }
 
 // Loads a Chip-8 application into memory starting from address 0x200
-bool Chip8::LoadApplication(const char * filename)
+template <class Access, class Quirks>
+bool Chip8Core<Access, Quirks>::LoadApplication(const char * filename)
 {
 	std::ifstream in(filename, std::ios::in | std::ios::binary);
 	if (in.good())
 	{
 		in.seekg(0, std::ios::end);
 		int length = int(in.tellg());
-		if (length > 4096 - 512)
-		{
-			std::cout << "The application is too big." << std::endl;
-			return false;
-		}
-
+		std::vector<unsigned char> application(length);
 		in.seekg(0, std::ios::beg);
-		in.read(reinterpret_cast<char *>(memory + 512), length);
+		in.read(reinterpret_cast<char *>(application.data()), length);
 		in.close();
 
-		return true;
+		return LoadApplication(application.data(), length);
 	}
 
-	std::cerr << "Error opening application file." << std::endl;
+	raise(Chip8EventType::ApplicationNotFound, 0, cycleCount);
 	return false;
 }
 
-// Emulates one cycle of the Chip8-Emulator
-void Chip8::EmulateCycle()
+// Loads a Chip-8 application from a buffer into memory
+template <class Access, class Quirks>
+bool Chip8Core<Access, Quirks>::LoadApplication(const unsigned char *application, size_t length)
 {
-	try
+	if (length > memorySize - 512)
 	{
-		// Fetch opcode
-		opcode = memory[pc] << 8 | memory[pc + 1];
+		raise(Chip8EventType::ApplicationTooBig, (unsigned int)length, cycleCount);
+		return false;
+	}
+
+	memory.Write(512, application, (unsigned int)length);
+	return true;
+}
 
-		// Process opcode
-		(this->*(decodeTable[(opcode & 0xF000) >> 12]))();
-		pc += 2;
+// Updates the timers as if the given number of cycles had passed
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::updateTimers(unsigned int cycles)
+{
+	delay_timer = (delay_timer > cycles) ? delay_timer - cycles : 0;
 
-		// Update timers
-		if (delay_timer > 0)
+	if (sound_timer > 0)
+	{
+		if (sound_timer <= cycles)
+		{
+			raise(Chip8EventType::SoundStop, 0, cycleCount + sound_timer);
+			sound_timer = 0;
+		}
+		else
 		{
-			--delay_timer;
+			sound_timer -= cycles;
 		}
+	}
 
-		if (sound_timer > 0)
+	cycleCount += cycles;
+}
+
+// Reports an event to the sink, if any
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::raise(Chip8EventType type, unsigned int data, unsigned long long cycle, const unsigned char *payload)
+{
+	if (events != nullptr)
+	{
+		Chip8Event event = { type, pc, data, cycle, {} };
+		if (payload != nullptr)
 		{
-			if (sound_timer == 1)
-			{
-				std::cout << "BEEP!" << std::endl;
-				if (soundEnabled)
-				{
-					std::cout << '\a';
-				}
-			}
-			--sound_timer;
+			memcpy(event.payload, payload, sizeof(event.payload));
 		}
+		events->Push(event);
 	}
-	catch (const std::exception &exc)
+}
+
+// Skips the next instruction. In XO-CHIP mode, F000 NNNN is skipped as a
+// whole.
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::skipInstruction()
+{
+	bool longInstruction = xoChip &&
+		memory.Get(Access::Memory(pc + 2, memorySize, fault)) == 0xF0 && memory.Get(Access::Memory(pc + 3, memorySize, fault)) == 0x00;
+	pc += longInstruction ? 4 : 2;
+}
+
+// Records an illegal opcode fault
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::illegalOpcode()
+{
+	fault = Chip8Fault::IllegalOpcode;
+}
+
+// Emulates one cycle. A faulting instruction leaves the program counter
+// and the timers untouched, so the state shows where the fault happened.
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::step()
+{
+	unsigned short address = pc;
+
+	// Fetch opcode
+	opcode = memory.Get(Access::Memory(pc, memorySize, fault)) << 8 | memory.Get(Access::Memory(pc + 1, memorySize, fault));
+
+	// Process opcode
+	(this->*(decodeTable[(opcode & 0xF000) >> 12]))();
+	if (fault != Chip8Fault::None)
 	{
-		std::cerr << "Exception: " << exc.what() << std::endl;
+		pc = faultPc = address;
+		raise(Chip8EventType::Fault, (unsigned int)fault, cycleCount);
+		return;
 	}
-}
\ No newline at end of file
+	pc += 2;
+
+	// Update timers
+	updateTimers(1);
+}
+
+// Emulates one cycle of the Chip8-Emulator
+template <class Access, class Quirks>
+void Chip8Core<Access, Quirks>::EmulateCycle()
+{
+	// A faulted emulator stays stopped until it is reset
+	if (fault == Chip8Fault::None)
+	{
+		step();
+	}
+}
+
+// Emulates up to the given number of cycles, stopping at a fault. Returns
+// the number of completed cycles.
+template <class Access, class Quirks>
+unsigned int Chip8Core<Access, Quirks>::Run(unsigned int cycles)
+{
+	unsigned int executed = 0;
+	while (executed < cycles && fault == Chip8Fault::None)
+	{
+		step();
+		if (fault == Chip8Fault::None)
+		{
+			++executed;
+		}
+	}
+	return executed;
+}
+
+// Emulates one frame of the given number of cycles. With the DISPLAY_WAIT
+// quirk, a draw waits for the vertical blank: the rest of the frame passes
+// without executing instructions, but the timers still count it down.
+// Returns the number of completed cycles, including the waited ones.
+template <class Access, class Quirks>
+unsigned int Chip8Core<Access, Quirks>::RunFrame(unsigned int cycles)
+{
+	unsigned int executed = 0;
+	while (executed < cycles && fault == Chip8Fault::None)
+	{
+		step();
+		if (fault != Chip8Fault::None)
+		{
+			break;
+		}
+		++executed;
+
+		if (Quirks::DISPLAY_WAIT && (opcode & 0xF000) == 0xD000)
+		{
+			updateTimers(cycles - executed);
+			executed = cycles;
+		}
+	}
+	return executed;
+}
+
+template class Chip8Core<Chip8RawAccess>;
+template class Chip8Core<Chip8WrapAccess>;
+template class Chip8Core<Chip8ClampAccess>;
+template class Chip8Core<Chip8TrapAccess>;
+template class Chip8Core<Chip8WrapAccess, Chip8VipQuirks>;
+template class Chip8Core<Chip8WrapAccess, Chip8SuperChipQuirks>;
+template class Chip8Core<Chip8WrapAccess, Chip8XoChipQuirks>;
@@ -6,71 +6,142 @@
  *	Header file for the Chip8 class. The class allows for emulation of the
  *	Chip-8 interpreted programming language. Emulation must be done by the
  *	class user one cycle at a time.
+ *
+ *	Chip8 is the Chip8Core class template with the wrapping access policy.
+ *	The policy parameter selects how out-of-bounds accesses of memory, stack
+ *	and screen are handled (see chip8_access.h); the core is instantiated
+ *	for every policy in chip8.cpp. The quirk profile parameter selects the
+ *	behaviour of the instructions Chip-8 platforms disagree on (see
+ *	chip8_quirks.h); the core is instantiated for every profile with the
+ *	wrapping access policy.
+ *
+ *	The core also runs SUPER-CHIP applications: 00FF and 00FE switch between
+ *	the 64x32 and the 128x64 screen, DXY0 draws 16x16 sprites and 00CN, 00FB
+ *	and 00FC scroll the screen.
+ *
+ *	With SetXoChip, it runs XO-CHIP applications as well. Memory grows to
+ *	64k (addressed with F000 NNNN), the screen gets a second bitplane and
+ *	FN01 selects the planes that clear, scroll and draw work on. 5XY2 and
+ *	5XY3 save and load register ranges, and 00DN scrolls up. Every plane is
+ *	a separate packed bitmap; the color of a pixel has one bit per plane.
  */
 
 #ifndef CHIP8
 #define CHIP8
 
-class Chip8 {
+#include "chip8_access.h"
+#include "chip8_events.h"
+#include "chip8_pages.h"
+#include "chip8_quirks.h"
+#include "chip8_screen.h"
+#include <cstddef>
+
+// Implemented by the translation units Chip8Recompiler generates, one
+// specialization per translated application.
+template <class Application> struct Chip8Translation;
+
+// Runs a core in the interpreter and predecoded tiers (chip8_tiered.h).
+template <class Core> class Chip8Tiered;
+
+template <class Access, class Quirks = Chip8DefaultQuirks>
+class Chip8Core {
 	public:
-		Chip8();
-		~Chip8();
+		Chip8Core();
+		~Chip8Core();
 		
-		const static unsigned int SCREEN_WIDTH  = 64;
-		const static unsigned int SCREEN_HEIGHT = 32;
+		const static unsigned int SCREEN_WIDTH  = Chip8Screen::WIDTH;	// Size of the high resolution screen.
+		const static unsigned int SCREEN_HEIGHT = Chip8Screen::HEIGHT;
+		const static unsigned int MEMORY_SIZE   = 4096;
+		const static unsigned int XO_MEMORY_SIZE = 65536;	// Size of the memory in XO-CHIP mode.
+		const static unsigned int STACK_SIZE    = 16;
+		const static unsigned int PLANE_COUNT   = 2;		// Number of XO-CHIP bitplanes.
+
+		typedef Access AccessPolicy;	// Access policy the core was instantiated with.
+		typedef Quirks QuirkProfile;	// Quirk profile the core was instantiated with.
 
 		void EmulateCycle();									// Emulate one cycle of the emulator.
+		unsigned int Run(unsigned int cycles);					// Emulate up to the given number of cycles, stopping at a fault. Returns the number of completed cycles.
+		unsigned int RunFrame(unsigned int cycles);				// Emulate one frame of the given number of cycles, waiting for its end after a draw if the quirks say so. Returns the number of completed cycles.
 		bool LoadApplication(const char *filename);				// Load a Chip-8 application from disk into memory.
-		void ToggleSound() { soundEnabled = !soundEnabled; }	// Toggles sound off or on.
+		bool LoadApplication(const unsigned char *application, size_t length);	// Load a Chip-8 application from a buffer into memory.
+		void Reset() { init(); }								// Reset the emulator to its state after construction.
+		void SetEventSink(Chip8EventSink *sink) { events = sink; }	// Report events to the sink (nullptr for none). Forks report to the same sink.
+		Chip8Core Fork() const { return *this; }				// Copy of the emulator that shares memory and screen pages until either copy writes to them.
+		void SetXoChip(bool xoChip);							// Enable or disable the XO-CHIP extensions. Resets the emulator, so call it before loading the application.
+		bool IsXoChip() const { return xoChip; }
+
+		unsigned int GetScreenWidth() const { return hires ? SCREEN_WIDTH : SCREEN_WIDTH / 2; }		// Width of the screen in the current resolution.
+		unsigned int GetScreenHeight() const { return hires ? SCREEN_HEIGHT : SCREEN_HEIGHT / 2; }	// Height of the screen in the current resolution.
+		unsigned char GetPixel(unsigned int x, unsigned int y) const { return screen[0].Get(x, y) | screen[1].Get(x, y) << 1; }	// Color of one pixel of the emulator screen (bit i is set in plane i).
+		const unsigned char *GetScreenRow(unsigned int y, unsigned int plane = 0) const { return screen[plane].Row(y); }	// Pixel state for all pixels of one row of a plane, packed eight pixels per byte (leftmost in the top bit).
+		unsigned char ReadMemory(unsigned short address) const { return memory.Get(address & (memorySize - 1)); }		// Reads one byte of emulator memory.
+
+		Chip8Fault GetFault() const { return fault; }			// Fault that stopped the emulator.
+		unsigned short GetFaultPc() const { return faultPc; }	// Address of the instruction that caused the fault.
+		unsigned long long GetCycleCount() const { return cycleCount; }	// Cycles emulated since the last reset.
 
-		unsigned char  screen[SCREEN_WIDTH * SCREEN_HEIGHT];	// Pixel state for all pixels of the emulator screen.
 		unsigned char  keys[16];								// Key state for all keys of the emulator keypad.
 
+		const static unsigned char fontset[80];					// Built-in 4x5 font for the characters 0-F.
+		const static unsigned char bigFontset[160];				// Built-in 8x10 font for the characters 0-F (SUPER-CHIP), stored after the small font.
+
 	private:	
+		template <class Application> friend struct Chip8Translation;
+		template <class Core> friend class Chip8Tiered;
+
 		unsigned short pc;				// Program counter.
 		unsigned short opcode;			// Current opcode.
 		unsigned short I;				// Index register.
 		unsigned short sp;				// Stack pointer.
 		
 		unsigned char  V[16];			// V-regs (V0-VF).
-		unsigned short stack[16];		// Stack (16 levels).
-		unsigned char  memory[4096];	// Memory (size = 4k).
+		unsigned short stack[STACK_SIZE];	// Stack (16 levels).
+
+		Chip8PageTable<XO_MEMORY_SIZE / Chip8Page::SIZE> memory;						// Memory (4k, or 64k in XO-CHIP mode), copy-on-write.
+		unsigned int   memorySize;		// Addressable memory in the current mode.
+		Chip8Screen    screen[PLANE_COUNT];	// Pixel state for all pixels of every plane of the emulator screen, copy-on-write.
+		unsigned char  planes;			// Planes selected by FN01 (bit i selects plane i).
+		bool		   hires;			// Whether the 128x64 screen is selected.
+		bool		   xoChip;			// Whether the XO-CHIP extensions are enabled.
+		unsigned char  flags[16];		// SUPER-CHIP user flags (FX75/FX85).
 				
 		unsigned char  delay_timer;		// Delay timer.
 		unsigned char  sound_timer;		// Sound timer.
-		bool		   soundEnabled;	// Whether or not the emulator will play the beep.
+		unsigned char  audioPattern[16];	// XO-CHIP audio pattern buffer (128 one-bit samples).
+		unsigned char  pitch;			// XO-CHIP pitch register.
+		bool		   codeModified;	// Set by translated code once the application wrote into its own code.
+		Chip8Fault	   fault;			// Fault that stopped the emulator.
+		unsigned short faultPc;			// Address of the instruction that caused the fault.
 
-		void init();
+		Chip8EventSink     *events;		// Receives the events of the emulator.
+		unsigned long long cycleCount;	// Cycles emulated since the last reset.
 
-		unsigned char fontset[80] =
-		{
-			0xF0, 0x90, 0x90, 0x90, 0xF0, // 0
-			0x20, 0x60, 0x20, 0x20, 0x70, // 1
-			0xF0, 0x10, 0xF0, 0x80, 0xF0, // 2
-			0xF0, 0x10, 0xF0, 0x10, 0xF0, // 3
-			0x90, 0x90, 0xF0, 0x10, 0x10, // 4
-			0xF0, 0x80, 0xF0, 0x10, 0xF0, // 5
-			0xF0, 0x80, 0xF0, 0x90, 0xF0, // 6
-			0xF0, 0x10, 0x20, 0x40, 0x40, // 7
-			0xF0, 0x90, 0xF0, 0x90, 0xF0, // 8
-			0xF0, 0x90, 0xF0, 0x10, 0xF0, // 9
-			0xF0, 0x90, 0xF0, 0x90, 0x90, // A
-			0xE0, 0x90, 0xE0, 0x90, 0xE0, // B
-			0xF0, 0x80, 0x80, 0x80, 0xF0, // C
-			0xE0, 0x90, 0x90, 0x90, 0xE0, // D
-			0xF0, 0x80, 0xF0, 0x80, 0xF0, // E
-			0xF0, 0x80, 0xF0, 0x80, 0x80  // F
-		};
+		void init();
+		void updateTimers(unsigned int cycles);	// Updates the timers as if the given number of cycles had passed.
+		void step();							// Emulates one cycle, recording the PC if the instruction faults.
+		void illegalOpcode();					// Records an illegal opcode fault.
+		void skipInstruction();					// Skips the next instruction, which is four bytes long if it is F000 NNNN.
+		bool drawPlane(Chip8Screen &plane, unsigned int address, unsigned int x, unsigned int y, unsigned int rows, unsigned int columns);	// Draws sprite data into one plane. Returns whether there was a collision.
+		void raise(Chip8EventType type, unsigned int data, unsigned long long cycle, const unsigned char *payload = nullptr);	// Reports an event to the sink, if any.
 
 		// Opcode functions
 		void decodeOpcode0();				// Decodes the opcode 0xxx.
+		void scrollDown();					// 00CN - Scrolls the screen down by N rows. (SUPER-CHIP)
+		void scrollUp();					// 00DN - Scrolls the screen up by N rows. (XO-CHIP)
 		void clearScreen();					// 00E0 - Clears the screen.
 		void returnFromSubroutine();		// 00EE - Returns from a subroutine.
+		void scrollRight();					// 00FB - Scrolls the screen right by 4 columns. (SUPER-CHIP)
+		void scrollLeft();					// 00FC - Scrolls the screen left by 4 columns. (SUPER-CHIP)
+		void lowResolution();				// 00FE - Switches to the 64x32 screen. (SUPER-CHIP)
+		void highResolution();				// 00FF - Switches to the 128x64 screen. (SUPER-CHIP)
 		void jumpToAddress();				// 1NNN - Jumps to address NNN.
 		void callSubroutine();				// 2NNN - Calls subroutine at NNN.
 		void skipInstructionIfEqualsN();	// 3XNN - Skips the next instruction if VX equals NN.
 		void skipInstructionIfNotEqualsN();	// 4XNN - Skips the next instruction if VX doesn't equal NN.
+		void decodeOpcode5();				// Decodes the opcode 5xxx.
 		void skipInstructionIfEquals();		// 5XY0 - Skips the next instruction if VX equals VY.
+		void saveRange();					// 5XY2 - Stores VX to VY (including VY) in memory starting at address I. (XO-CHIP)
+		void loadRange();					// 5XY3 - Fills VX to VY (including VY) with values from memory starting at address I. (XO-CHIP)
 		void setToN();						// 6XNN - Sets VX to NN.
 		void AddN();						// 7XNN - Adds NN to VX.
 		void decodeOpcode8();				// Decodes the opcode 8xxx.
@@ -85,61 +156,55 @@ class Chip8 {
 		void bitwiseShiftLeft();			// 8XYE - Shifts VX left by one. VF is set to the value of the most significant bit of VX before the shift.
 		void skipInstructionIfNotEquals();	// 9XY0 - Skips the next instruction if VX doesn't equal VY.
 		void setI();						// ANNN - Sets I to the address NNN.
-		void jumpToAddressPlus();			// BNNN - Jumps to the address NNN plus V0.
+		void jumpToAddressPlus();			// BNNN - Jumps to the address NNN plus V0 (or BXNN - XNN plus VX, depending on the quirks).
 		void setRandom();					// CXNN - Sets VX to the result of a bitwise and operation on a random number (0 to 255) and NN.
 		void drawSprite();					// DXYN - Draws a sprite at coordinate (VX, VY) that has a width of 8 pixels and a height of N pixels.
 											//        Each row of 8 pixels is read as bit-coded starting from memory location I;
 											//        I value doesnt change after the execution of this instruction. As described above,
 											//        VF is set to 1 if any screen pixels are flipped from set to unset when the sprite is drawn,
 											//        and to 0 if that doesnt happen.
+											//        DXY0 draws a 16x16 sprite from 32 bytes starting at I. (SUPER-CHIP)
 		void decodeOpcodeE();				// Decodes the opcode Exxx.
 		void skipIfKeyPressed();			// EX9E - Skips the next instruction if the key stored in VX is pressed. (Usually the next instruction is a jump to skip a code block)
 		void skipIfKeyNotPressed();			// EXA1 - Skips the next instruction if the key stored in VX isn't pressed. (Usually the next instruction is a jump to skip a code block)
 		void decodeOpcodeF();				// Decodes the opcode Fxxx.
+		void setLongI();					// F000 NNNN - Sets I to the 16-bit address NNNN. (XO-CHIP)
+		void selectPlanes();				// FN01 - Selects the planes drawn to by N. (XO-CHIP)
+		void loadAudioPattern();			// F002 - Loads 16 bytes starting at I into the audio pattern buffer. (XO-CHIP)
 		void getDelay();					// FX07 - Sets VX to the value of the delay timer.
 		void getKey();						// FX0A - A key press is awaited, and then stored in VX. (Blocking Operation. All instruction halted until next key event)
 		void setDelay();					// FX15 - Sets the delay timer to VX.
 		void setSound();					// FX18 - Sets the sound timer to VX.
+		void setPitch();					// FX3A - Sets the pitch register to VX. (XO-CHIP)
 		void addToI();						// FX1E - Adds VX to I.
 		void findCharacter();				// FX29 - Sets I to the location of the sprite for the character in VX. Characters 0-F (in hexadecimal) are represented by a 4x5 font.
+		void findBigCharacter();			// FX30 - Sets I to the location of the 8x10 sprite for the character in VX. (SUPER-CHIP)
 		void setBCD();						// FX33 - Stores the binary-coded decimal representation of VX, with the most significant of three digits at the address in I,
 											//        the middle digit at I plus 1, and the least significant digit at I plus 2. (In other words, take the decimal representation of VX,
 											//        place the hundreds digit in memory at location in I, the tens digit at location I+1, and the ones digit at location I+2.)
 		void storeRegisters();				// FX55 - Stores V0 to VX (including VX) in memory starting at address I.
 		void loadRegisters();				// FX65 - Fills V0 to VX (including VX) with values from memory starting at address I.
+		void storeFlags();					// FX75 - Stores V0 to VX (including VX) in the user flags. (SUPER-CHIP)
+		void loadFlags();					// FX85 - Fills V0 to VX (including VX) with values from the user flags. (SUPER-CHIP)
 
-		// Decode table for the emulator opcodes
-		void (Chip8::*decodeTable[16])() =
-		{
-			&Chip8::decodeOpcode0, &Chip8::jumpToAddress,
-			&Chip8::callSubroutine, &Chip8::skipInstructionIfEqualsN,
-			&Chip8::skipInstructionIfNotEqualsN, &Chip8::skipInstructionIfEquals,
-			&Chip8::setToN, &Chip8::AddN,
-			&Chip8::decodeOpcode8, &Chip8::skipInstructionIfNotEquals,
-			&Chip8::setI, &Chip8::jumpToAddressPlus,
-			&Chip8::setRandom, &Chip8::drawSprite,
-			&Chip8::decodeOpcodeE, &Chip8::decodeOpcodeF
-		};
-
-		// Decode table for opcodes 0xxx
-		void(Chip8::*opcode0DecodeTable[2])() =
-		{
-			&Chip8::clearScreen, &Chip8::returnFromSubroutine
-		};
-
-		// Decode table for opcodes 8xxx
-		void(Chip8::*opcode8DecodeTable[9])() =
-		{
-			&Chip8::assign, &Chip8::bitwiseOr, &Chip8::bitwiseAnd, &Chip8::bitwiseXor,
-			&Chip8::add, &Chip8::subtract, &Chip8::bitwiseShiftRight,
-			&Chip8::reverseSubtract, &Chip8::bitwiseShiftLeft
-		};
-
-		// Decode table for opcodes Exxx
-		void(Chip8::*opcodeEDecodeTable[2])() =
-		{
-			&Chip8::skipIfKeyPressed, &Chip8::skipIfKeyNotPressed
-		};
+		// Decode tables for the emulator opcodes
+		static void (Chip8Core::* const decodeTable[16])();			// Opcodes by their first nibble.
+		static void (Chip8Core::* const opcode8DecodeTable[9])();	// Opcodes 8xxx.
+		static void (Chip8Core::* const opcodeEDecodeTable[2])();	// Opcodes Exxx.
 };
 
+// Instantiated in chip8.cpp
+extern template class Chip8Core<Chip8RawAccess>;
+extern template class Chip8Core<Chip8WrapAccess>;
+extern template class Chip8Core<Chip8ClampAccess>;
+extern template class Chip8Core<Chip8TrapAccess>;
+extern template class Chip8Core<Chip8WrapAccess, Chip8VipQuirks>;
+extern template class Chip8Core<Chip8WrapAccess, Chip8SuperChipQuirks>;
+extern template class Chip8Core<Chip8WrapAccess, Chip8XoChipQuirks>;
+
+typedef Chip8Core<Chip8WrapAccess> Chip8;
+typedef Chip8Core<Chip8WrapAccess, Chip8VipQuirks> Chip8Vip;
+typedef Chip8Core<Chip8WrapAccess, Chip8SuperChipQuirks> Chip8SuperChip;
+typedef Chip8Core<Chip8WrapAccess, Chip8XoChipQuirks> Chip8XoChip;
+
 #endif
\ No newline at end of file
@@ -0,0 +1,120 @@
+/**
+ *	@file	chip8_access.h
+ *	@author	Dejan Azinovic (dazinovic)
+ *	@date	18.10.2026
+ *
+ *	Access policies for the Chip8Core class template. A policy decides what
+ *	happens when an application addresses memory, the stack or the screen
+ *	outside of their bounds:
+ *
+ *		Chip8RawAccess		No checks at all (fastest, undefined behaviour on bad applications).
+ *		Chip8WrapAccess		Addresses wrap around (memory at 4k or 64k, stack at 16 levels, screen at its edges).
+ *		Chip8ClampAccess	Addresses are clamped to the last valid entry, pixels outside the screen are clipped.
+ *		Chip8TrapAccess		A fault is recorded that stops the emulator after the instruction. Until
+ *							then, addresses wrap and pixels outside the screen are clipped.
+ *
+ *	Every policy function is static and inlined into the core, so the raw
+ *	policy compiles to plain unchecked accesses. Illegal opcodes are trapped
+ *	by the core regardless of the policy.
+ */
+
+#ifndef CHIP8_ACCESS
+#define CHIP8_ACCESS
+
+// Fault codes that stop the emulator
+enum class Chip8Fault : unsigned char {
+	None,				// No fault occurred.
+	IllegalOpcode,		// The opcode is not a Chip-8 instruction.
+	MemoryOutOfBounds,	// An address beyond the end of memory was accessed.
+	StackOverflow,		// 2NNN was executed with a full stack.
+	StackUnderflow,		// 00EE was executed with an empty stack.
+	ScreenOutOfBounds	// A sprite was drawn past the edge of the screen.
+};
+
+// Returns a readable name of a fault code
+inline const char *Chip8FaultName(Chip8Fault fault)
+{
+	switch (fault)
+	{
+	case Chip8Fault::None:				return "none";
+	case Chip8Fault::IllegalOpcode:		return "illegal opcode";
+	case Chip8Fault::MemoryOutOfBounds:	return "memory access out of bounds";
+	case Chip8Fault::StackOverflow:		return "stack overflow";
+	case Chip8Fault::StackUnderflow:	return "stack underflow";
+	case Chip8Fault::ScreenOutOfBounds:	return "pixel out of bounds";
+	}
+	return "unknown";
+}
+
+struct Chip8RawAccess {
+	static unsigned int Memory(unsigned int address, unsigned int, Chip8Fault &) { return address; }
+	static unsigned int Push(unsigned int sp, unsigned int, Chip8Fault &) { return sp; }
+	static unsigned int Pop(unsigned int sp, unsigned int, Chip8Fault &) { return sp - 1; }
+	static bool Pixel(unsigned int &, unsigned int &, unsigned int, unsigned int, Chip8Fault &) { return true; }
+};
+
+struct Chip8WrapAccess {
+	// Sizes are powers of two, so the modulo is a mask. The memory size is
+	// only known at run time, so the mask is spelled out.
+	static unsigned int Memory(unsigned int address, unsigned int size, Chip8Fault &) { return address & (size - 1); }
+	static unsigned int Push(unsigned int sp, unsigned int depth, Chip8Fault &) { return sp & (depth - 1); }
+	static unsigned int Pop(unsigned int sp, unsigned int depth, Chip8Fault &) { return (sp - 1) & (depth - 1); }
+
+	static bool Pixel(unsigned int &x, unsigned int &y, unsigned int width, unsigned int height, Chip8Fault &)
+	{
+		x &= width - 1;
+		y &= height - 1;
+		return true;
+	}
+};
+
+struct Chip8ClampAccess {
+	static unsigned int Memory(unsigned int address, unsigned int size, Chip8Fault &) { return (address < size) ? address : size - 1; }
+	static unsigned int Push(unsigned int sp, unsigned int depth, Chip8Fault &) { return (sp < depth) ? sp : depth - 1; }
+	static unsigned int Pop(unsigned int sp, unsigned int, Chip8Fault &) { return (sp > 0) ? sp - 1 : 0; }
+	static bool Pixel(unsigned int &x, unsigned int &y, unsigned int width, unsigned int height, Chip8Fault &) { return x < width && y < height; }
+};
+
+struct Chip8TrapAccess {
+	static unsigned int Memory(unsigned int address, unsigned int size, Chip8Fault &fault)
+	{
+		if (address < size)
+		{
+			return address;
+		}
+		fault = Chip8Fault::MemoryOutOfBounds;
+		return address % size;
+	}
+
+	static unsigned int Push(unsigned int sp, unsigned int depth, Chip8Fault &fault)
+	{
+		if (sp < depth)
+		{
+			return sp;
+		}
+		fault = Chip8Fault::StackOverflow;
+		return sp % depth;
+	}
+
+	static unsigned int Pop(unsigned int sp, unsigned int depth, Chip8Fault &fault)
+	{
+		if (sp > 0)
+		{
+			return sp - 1;
+		}
+		fault = Chip8Fault::StackUnderflow;
+		return depth - 1;
+	}
+
+	static bool Pixel(unsigned int &x, unsigned int &y, unsigned int width, unsigned int height, Chip8Fault &fault)
+	{
+		if (x < width && y < height)
+		{
+			return true;
+		}
+		fault = Chip8Fault::ScreenOutOfBounds;
+		return false;
+	}
+};
+
+#endif
@@ -0,0 +1,518 @@
+/**
+ *	@file	chip8_analyzer.cpp
+ *	@author	Dejan Azinovic (dazinovic)
+ *	@date	18.10.2026
+ *
+ *	Contains an implementation of all methods from the chip8_analyzer header.
+ */
+
+#include "chip8_analyzer.h"
+#include <algorithm>
+#include <list>
+#include <mutex>
+#include <set>
+
+const static unsigned int MAX_V = 0xFF;
+const static unsigned int MAX_I = 0xFFFF;
+
+Chip8Analyzer::Chip8Analyzer(const unsigned char *memory, unsigned int size, bool jumpUsesVx, bool loadStoreIncrementsI)
+	: memory(memory), size(size), jumpUsesVx(jumpUsesVx), loadStoreIncrementsI(loadStoreIncrementsI), code(size, false)
+{
+	result.hash = 0;
+	result.instructions = 0;
+	result.subroutines = 0;
+	result.unresolvedJumps = 0;
+	result.maxCallDepth = 0;
+	result.stackUnderflow = false;
+	result.writesCode = false;
+}
+
+// Looks the memory image up in the cache, or analyzes it. The cache is a
+// list with the most recently used result in front, which is short enough
+// to search linearly.
+Chip8Analysis Chip8Analyzer::analyze(const unsigned char *memory, unsigned int size, bool jumpUsesVx, bool loadStoreIncrementsI)
+{
+	typedef std::pair<std::pair<unsigned long long, unsigned int>, Chip8Analysis> Entry;
+	static std::mutex mutex;
+	static std::list<Entry> cache;
+
+	unsigned long long hash = 14695981039346656037ULL;
+	for (unsigned int i = 0; i < size; i++)
+	{
+		hash = (hash ^ memory[i]) * 1099511628211ULL;
+	}
+	std::pair<unsigned long long, unsigned int> key(hash, (jumpUsesVx ? 1 : 0) | (loadStoreIncrementsI ? 2 : 0));
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		for (std::list<Entry>::iterator it = cache.begin(); it != cache.end(); ++it)
+		{
+			if (it->first == key)
+			{
+				cache.splice(cache.begin(), cache, it);
+				return cache.front().second;
+			}
+		}
+	}
+
+	Chip8Analyzer analyzer(memory, size, jumpUsesVx, loadStoreIncrementsI);
+	analyzer.interpret();
+	analyzer.checkWrites();
+	analyzer.checkCalls();
+	analyzer.result.hash = hash;
+	analyzer.result.instructions = (unsigned int)analyzer.states.size();
+
+	std::lock_guard<std::mutex> lock(mutex);
+	cache.push_front(Entry(key, analyzer.result));
+	if (cache.size() > CACHE_SIZE)
+	{
+		cache.pop_back();
+	}
+	return analyzer.result;
+}
+
+// Runs the abstract interpretation from 0x200 to a fixpoint. The emulator
+// starts with every register cleared.
+void Chip8Analyzer::interpret()
+{
+	State entry;
+	for (unsigned int i = 0; i < 16; i++)
+	{
+		entry.V[i].lo = entry.V[i].hi = 0;
+	}
+	entry.I.lo = entry.I.hi = 0;
+	entry.visits = 0;
+	merge(0x200, entry);
+
+	std::vector<unsigned int> worklist(1, 0x200);
+	std::vector<std::pair<unsigned int, State> > next;
+	while (!worklist.empty())
+	{
+		unsigned int address = worklist.back();
+		worklist.pop_back();
+
+		next.clear();
+		step(address, states[address], next);
+		for (size_t i = 0; i < next.size(); i++)
+		{
+			if (merge(next[i].first, next[i].second))
+			{
+				worklist.push_back(next[i].first);
+			}
+		}
+	}
+}
+
+// Joins a state into the one of an instruction. A range that keeps growing
+// (usually a loop counter) becomes unknown, so the interpretation ends.
+bool Chip8Analyzer::merge(unsigned int address, const State &state)
+{
+	std::map<unsigned int, State>::iterator it = states.find(address);
+	if (it == states.end())
+	{
+		states[address] = state;
+		states[address].visits = 1;
+		return true;
+	}
+
+	State &old = it->second;
+	bool widen = ++old.visits > WIDEN_AFTER;
+	bool changed = false;
+	for (unsigned int i = 0; i <= 16; i++)
+	{
+		Range &range = (i < 16) ? old.V[i] : old.I;
+		const Range &joined = (i < 16) ? state.V[i] : state.I;
+		if (joined.lo < range.lo || joined.hi > range.hi)
+		{
+			range.lo = widen ? 0 : std::min(range.lo, joined.lo);
+			range.hi = widen ? ((i < 16) ? MAX_V : MAX_I) : std::max(range.hi, joined.hi);
+			changed = true;
+		}
+	}
+	return changed;
+}
+
+// Abstract transfer of one instruction: collects the successors with the
+// state after the instruction, and records the control flow.
+void Chip8Analyzer::step(unsigned int address, const State &state, std::vector<std::pair<unsigned int, State> > &next)
+{
+	if (address + 1 >= size)
+	{
+		++result.unresolvedJumps;		// The program counter wraps around
+		return;
+	}
+	code[address] = code[address + 1] = true;
+
+	unsigned short opcode = fetch(address);
+	unsigned int x = (opcode & 0x0F00) >> 8;
+	unsigned int y = (opcode & 0x00F0) >> 4;
+	unsigned int nn = opcode & 0x00FF;
+	unsigned int nnn = opcode & 0x0FFF;
+	const Range unknown = { 0, MAX_V };
+	const Range unknownI = { 0, MAX_I };
+
+	State after = state;
+	bool fallsThrough = true;		// Whether the next instruction follows.
+	bool skips = false;				// Whether the one after it follows as well.
+	int call = -1;					// Target of 2NNN.
+
+	switch (opcode & 0xF000)
+	{
+	case 0x0000:
+		fallsThrough = (opcode & 0xFFF0) == 0x00C0 || (opcode & 0xFFF0) == 0x00D0 || opcode == 0x00E0 ||
+			(opcode >= 0x00FB && opcode <= 0x00FF && opcode != 0x00FD);
+		break;
+	case 0x1000:
+		fallsThrough = false;
+		next.push_back(std::make_pair(nnn, after));
+		break;
+	case 0x2000:
+		call = nnn;
+		next.push_back(std::make_pair(nnn, after));
+		for (unsigned int i = 0; i < 16; i++)
+		{
+			after.V[i] = unknown;		// The subroutine may change anything before it returns
+		}
+		after.I = unknownI;
+		break;
+	case 0x3000:
+	case 0x4000:
+		skips = true;
+		break;
+	case 0x5000:
+		switch (opcode & 0x000F)
+		{
+		case 0x0:
+			skips = true;
+			break;
+		case 0x2:
+			fallsThrough = isXoChip();
+			break;
+		case 0x3:
+			fallsThrough = isXoChip();
+			for (unsigned int i = std::min(x, y); i <= std::max(x, y); i++)
+			{
+				after.V[i] = unknown;
+			}
+			break;
+		default:
+			fallsThrough = false;
+			break;
+		}
+		break;
+	case 0x6000:
+		after.V[x].lo = after.V[x].hi = nn;
+		break;
+	case 0x7000:
+		if (after.V[x].hi + nn <= MAX_V)
+		{
+			after.V[x].lo += nn;
+			after.V[x].hi += nn;
+		}
+		else
+		{
+			after.V[x] = unknown;
+		}
+		break;
+	case 0x8000:
+		switch (opcode & 0x000F)
+		{
+		case 0x0:
+			after.V[x] = state.V[y];
+			break;
+		case 0x2:
+			after.V[x].lo = 0;
+			after.V[x].hi = std::min(state.V[x].hi, state.V[y].hi);
+			after.V[0xF] = unknown;		// The logic operations may reset VF
+			break;
+		case 0x1: case 0x3: case 0x4: case 0x5: case 0x6: case 0x7: case 0xE:
+			after.V[x] = unknown;
+			after.V[0xF] = unknown;
+			break;
+		default:
+			fallsThrough = false;
+			break;
+		}
+		break;
+	case 0x9000:
+		skips = (opcode & 0x000F) == 0;
+		fallsThrough = skips;
+		break;
+	case 0xA000:
+		after.I.lo = after.I.hi = nnn;
+		break;
+	case 0xB000:
+		{
+			fallsThrough = false;
+			const Range &offset = state.V[jumpUsesVx ? x : 0];
+			if (offset.hi - offset.lo + 1 > MAX_JUMP_TARGETS)
+			{
+				++result.unresolvedJumps;
+				break;
+			}
+			for (unsigned int v = offset.lo; v <= offset.hi; v++)
+			{
+				next.push_back(std::make_pair(nnn + v, after));
+			}
+		}
+		break;
+	case 0xC000:
+		after.V[x].lo = 0;
+		after.V[x].hi = nn;
+		break;
+	case 0xD000:
+		after.V[0xF].lo = 0;
+		after.V[0xF].hi = 1;
+		break;
+	case 0xE000:
+		skips = nn == 0x9E || nn == 0xA1;
+		fallsThrough = skips;
+		break;
+	case 0xF000:
+		switch (nn)
+		{
+		case 0x00:
+			fallsThrough = false;
+			if (opcode == 0xF000 && isXoChip() && address + 3 < size)
+			{
+				code[address + 2] = code[address + 3] = true;
+				after.I.lo = after.I.hi = fetch(address + 2);
+				next.push_back(std::make_pair(address + 4, after));
+			}
+			break;
+		case 0x01:
+			fallsThrough = isXoChip() && x <= 3;
+			break;
+		case 0x02:
+			fallsThrough = isXoChip() && x == 0;
+			break;
+		case 0x07:
+			after.V[x] = unknown;
+			break;
+		case 0x0A:
+			after.V[x].lo = 0;
+			after.V[x].hi = 15;
+			next.push_back(std::make_pair(address, after));		// Waits for a key
+			break;
+		case 0x15: case 0x18: case 0x33: case 0x75:
+			break;
+		case 0x3A:
+			fallsThrough = isXoChip();
+			break;
+		case 0x1E:
+			{
+				Range offset = state.V[x];
+				if (x == 0xF)
+				{
+					offset.lo = 0;		// I is advanced by the carry, which was just written to VF
+					offset.hi = 1;
+				}
+				if (state.I.hi + offset.hi <= MAX_I)
+				{
+					after.I.lo = state.I.lo + offset.lo;
+					after.I.hi = state.I.hi + offset.hi;
+				}
+				else
+				{
+					after.I = unknownI;
+				}
+				after.V[0xF].lo = 0;
+				after.V[0xF].hi = 1;
+			}
+			break;
+		case 0x29:
+			after.I.lo = 0;
+			after.I.hi = 15 * 5;
+			break;
+		case 0x30:
+			after.I.lo = 80;
+			after.I.hi = 80 + 15 * 10;
+			break;
+		case 0x55:
+		case 0x65:
+		case 0x85:
+			for (unsigned int i = 0; nn != 0x55 && i <= x; i++)
+			{
+				after.V[i] = unknown;
+			}
+			if (nn != 0x85 && loadStoreIncrementsI)
+			{
+				if (after.I.hi + x + 1 <= MAX_I)
+				{
+					after.I.lo += x + 1;
+					after.I.hi += x + 1;
+				}
+				else
+				{
+					after.I = unknownI;
+				}
+			}
+			break;
+		default:
+			fallsThrough = false;
+			break;
+		}
+		break;
+	}
+
+	if (fallsThrough)
+	{
+		next.push_back(std::make_pair(address + 2, after));
+		if (skips)
+		{
+			next.push_back(std::make_pair(skip(address), after));
+		}
+	}
+
+	// The control flow within the subroutine leaves out the call itself
+	std::vector<unsigned int> &targets = successors[address];
+	for (size_t i = (call >= 0) ? 1 : 0; i < next.size(); i++)
+	{
+		if (std::find(targets.begin(), targets.end(), next[i].first) == targets.end())
+		{
+			targets.push_back(next[i].first);
+		}
+	}
+	if (call >= 0)
+	{
+		calls[address] = call;
+	}
+}
+
+// Target of a skip at the address. XO-CHIP skips F000 NNNN as a whole.
+unsigned int Chip8Analyzer::skip(unsigned int address) const
+{
+	if (isXoChip() && address + 3 < size && fetch(address + 2) == 0xF000)
+	{
+		return address + 6;
+	}
+	return address + 4;
+}
+
+// Checks whether FX33, FX55 or 5XY2 might write into reachable code
+void Chip8Analyzer::checkWrites()
+{
+	for (std::map<unsigned int, State>::const_iterator it = states.begin(); it != states.end(); ++it)
+	{
+		if (it->first + 1 >= size)
+		{
+			continue;
+		}
+
+		unsigned short opcode = fetch(it->first);
+		unsigned int x = (opcode & 0x0F00) >> 8;
+		unsigned int y = (opcode & 0x00F0) >> 4;
+		unsigned int length = 0;
+		if ((opcode & 0xF0FF) == 0xF033)
+		{
+			length = 3;
+		}
+		else if ((opcode & 0xF0FF) == 0xF055)
+		{
+			length = x + 1;
+		}
+		else if ((opcode & 0xF00F) == 0x5002 && isXoChip())
+		{
+			length = ((x < y) ? y - x : x - y) + 1;
+		}
+		if (length == 0)
+		{
+			continue;
+		}
+
+		// Writes past the end of memory wrap around to anywhere
+		const Range &target = it->second.I;
+		unsigned int last = target.hi + length - 1;
+		if (last >= size)
+		{
+			result.writesCode = true;
+			return;
+		}
+		for (unsigned int a = target.lo; a <= last; a++)
+		{
+			if (code[a])
+			{
+				result.writesCode = true;
+				return;
+			}
+		}
+	}
+}
+
+// Computes the deepest nesting of calls, and whether the main program
+// returns from a subroutine it never called
+void Chip8Analyzer::checkCalls()
+{
+	std::set<unsigned int> targets;
+	for (std::map<unsigned int, unsigned int>::const_iterator it = calls.begin(); it != calls.end(); ++it)
+	{
+		targets.insert(it->second);
+	}
+	result.subroutines = (unsigned int)targets.size();
+
+	std::vector<unsigned int> main;
+	body(0x200, main);
+	for (size_t i = 0; i < main.size(); i++)
+	{
+		if (main[i] + 1 < size && fetch(main[i]) == 0x00EE)
+		{
+			result.stackUnderflow = true;
+		}
+	}
+
+	std::map<unsigned int, int> depths;
+	result.maxCallDepth = callDepth(0x200, depths);
+}
+
+// Collects the instructions of a subroutine, without the ones it calls
+void Chip8Analyzer::body(unsigned int entry, std::vector<unsigned int> &addresses) const
+{
+	std::set<unsigned int> visited;
+	std::vector<unsigned int> worklist(1, entry);
+	while (!worklist.empty())
+	{
+		unsigned int address = worklist.back();
+		worklist.pop_back();
+		if (!visited.insert(address).second)
+		{
+			continue;
+		}
+		addresses.push_back(address);
+
+		std::map<unsigned int, std::vector<unsigned int> >::const_iterator it = successors.find(address);
+		if (it != successors.end())
+		{
+			worklist.insert(worklist.end(), it->second.begin(), it->second.end());
+		}
+	}
+}
+
+// Returns the deepest nesting of calls below a subroutine, or -1 if it can
+// call itself
+int Chip8Analyzer::callDepth(unsigned int subroutine, std::map<unsigned int, int> &depths) const
+{
+	const int ACTIVE = -2;
+	std::map<unsigned int, int>::const_iterator known = depths.find(subroutine);
+	if (known != depths.end())
+	{
+		return (known->second == ACTIVE) ? -1 : known->second;
+	}
+	depths[subroutine] = ACTIVE;
+
+	std::vector<unsigned int> addresses;
+	body(subroutine, addresses);
+
+	int depth = 0;
+	for (size_t i = 0; i < addresses.size() && depth >= 0; i++)
+	{
+		std::map<unsigned int, unsigned int>::const_iterator call = calls.find(addresses[i]);
+		if (call != calls.end())
+		{
+			int below = callDepth(call->second, depths);
+			depth = (below < 0) ? -1 : std::max(depth, below + 1);
+		}
+	}
+
+	depths[subroutine] = depth;
+	return depth;
+}
@@ -0,0 +1,100 @@
+/**
+ *	@file	chip8_analyzer.h
+ *	@author	Dejan Azinovic (dazinovic)
+ *	@date	18.10.2026
+ *
+ *	Header file for the Chip8Analyzer class, a static analyzer for Chip-8
+ *	applications. Starting at 0x200, it follows every statically reachable
+ *	instruction with an abstract interpretation of the registers: each of
+ *	V0-VF and I is tracked as a range of values. The ranges let it
+ *
+ *		- resolve BNNN, as long as the range of V0 has at most MAX_JUMP_TARGETS values,
+ *		- bound the nesting of 2NNN calls, to compare it against the 16-entry stack,
+ *		- prove that FX33, FX55 and 5XY2 never write into reachable code.
+ *
+ *	The analysis is conservative. After a call returns, every register is
+ *	unknown, and loops widen their ranges to unknown after a few iterations.
+ *	A proof only holds for a complete analysis (every BNNN resolved). Then the
+ *	faster execution tiers can drop their self-modification checks, and
+ *	applications with a bounded stack never overflow or underflow it.
+ *
+ *	The results of the last CACHE_SIZE memory images are cached per hash, so
+ *	analyzing the same application again is a lookup. The least recently
+ *	used result is dropped to make room for a new one.
+ */
+
+#ifndef CHIP8_ANALYZER
+#define CHIP8_ANALYZER
+
+#include <map>
+#include <vector>
+
+struct Chip8Analysis {
+	unsigned long long hash;			// FNV-1a hash of the memory image.
+	unsigned int       instructions;	// Reachable instructions.
+	unsigned int       subroutines;		// Reachable 2NNN targets.
+	unsigned int       unresolvedJumps;	// BNNN whose targets could not be bounded, or code running off the end of memory.
+	int                maxCallDepth;	// Deepest nesting of 2NNN calls, or -1 if the calls are recursive.
+	bool               stackUnderflow;	// Whether 00EE is reachable outside of every subroutine.
+	bool               writesCode;		// Whether FX33, FX55 or 5XY2 might write into reachable code.
+
+	bool IsComplete() const { return unresolvedJumps == 0; }								// Whether all reachable code was found.
+	bool IsStackSafe() const { return IsComplete() && maxCallDepth >= 0 && maxCallDepth <= 16 && !stackUnderflow; }	// Whether the stack never overflows or underflows.
+	bool IsCodeWriteFree() const { return IsComplete() && !writesCode; }					// Whether the application never modifies its code.
+};
+
+class Chip8Analyzer {
+	public:
+		const static unsigned int MAX_JUMP_TARGETS = 64;	// Largest V0 range BNNN is resolved for.
+		const static unsigned int WIDEN_AFTER = 8;			// Visits of an instruction before growing ranges become unknown.
+		const static unsigned int CACHE_SIZE = 64;			// Results kept for memory images analyzed again.
+
+		// Analyzes a memory image of 4k (or 64k in XO-CHIP mode) with the application at 0x200
+		template <class Quirks>
+		static Chip8Analysis Analyze(const unsigned char *memory, unsigned int size) { return analyze(memory, size, Quirks::JUMP_USES_VX, Quirks::LOAD_STORE_INCREMENTS_I); }
+
+	private:
+		// Range of values of a register
+		struct Range {
+			unsigned int lo;
+			unsigned int hi;
+		};
+
+		// Abstract state before an instruction
+		struct State {
+			Range        V[16];
+			Range        I;
+			unsigned int visits;
+		};
+
+		const unsigned char *memory;
+		unsigned int         size;
+		bool                 jumpUsesVx;
+		bool                 loadStoreIncrementsI;
+
+		std::map<unsigned int, State> states;								// Reachable instructions.
+		std::map<unsigned int, std::vector<unsigned int> > successors;		// Control flow within a subroutine.
+		std::map<unsigned int, unsigned int> calls;							// 2NNN instructions and their targets.
+		std::vector<bool>    code;											// Bytes of reachable instructions.
+		Chip8Analysis        result;
+
+		Chip8Analyzer(const unsigned char *memory, unsigned int size, bool jumpUsesVx, bool loadStoreIncrementsI);
+		Chip8Analyzer(const Chip8Analyzer &);
+		Chip8Analyzer &operator=(const Chip8Analyzer &);
+
+		static Chip8Analysis analyze(const unsigned char *memory, unsigned int size, bool jumpUsesVx, bool loadStoreIncrementsI);	// Looks the image up in the cache, or analyzes it.
+
+		void interpret();												// Runs the abstract interpretation to a fixpoint.
+		void step(unsigned int address, const State &state, std::vector<std::pair<unsigned int, State> > &next);	// Abstract transfer of one instruction.
+		bool merge(unsigned int address, const State &state);			// Joins a state into the one of an instruction. Returns whether it changed.
+		void checkWrites();
+		void checkCalls();
+		void body(unsigned int entry, std::vector<unsigned int> &addresses) const;	// Instructions of a subroutine, without the ones it calls.
+		int callDepth(unsigned int subroutine, std::map<unsigned int, int> &depths) const;	// Deepest nesting below a subroutine, -1 if recursive.
+
+		unsigned short fetch(unsigned int address) const { return memory[address] << 8 | memory[address + 1]; }
+		unsigned int skip(unsigned int address) const;					// Target of a skip at the address.
+		bool isXoChip() const { return size > 4096; }
+};
+
+#endif
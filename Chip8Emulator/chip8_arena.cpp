@@ -0,0 +1,154 @@
+/**
+ *	@file	chip8_arena.cpp
+ *	@author	Dejan Azinovic (dazinovic)
+ *	@date	18.10.2026
+ *
+ *	Contains an implementation of all methods from the chip8_arena header.
+ */
+
+#include "chip8_arena.h"
+#include <new>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+Chip8Arena::Chip8Arena(bool hugePages) : count(0), hugePages(hugePages), hugePagesUsed(false)
+{
+	instancesPerSlab = SLAB_SIZE / sizeof(Chip8);
+}
+
+Chip8Arena::~Chip8Arena()
+{
+	Clear();
+}
+
+// Creates one instance as a copy of the image
+Chip8 *Chip8Arena::Create(const Chip8 &image)
+{
+	if (count == slabs.size() * instancesPerSlab)
+	{
+		allocateSlab();
+	}
+
+	Chip8 *chip8 = new (instance(count)) Chip8(image);
+	++count;
+	return chip8;
+}
+
+// Creates count instances as copies of the image
+void Chip8Arena::Create(const Chip8 &image, size_t count)
+{
+	slabs.reserve((this->count + count + instancesPerSlab - 1) / instancesPerSlab);
+	for (size_t i = 0; i < count; i++)
+	{
+		Create(image);
+	}
+}
+
+// Resets every instance to the image
+void Chip8Arena::Reset(const Chip8 &image)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		*instance(i) = image;
+	}
+}
+
+// Destroys all instances and releases the slabs
+void Chip8Arena::Clear()
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		instance(i)->~Chip8();
+	}
+	for (size_t i = 0; i < slabs.size(); i++)
+	{
+		freePages(slabs[i].memory, slabs[i].size);
+	}
+
+	slabs.clear();
+	count = 0;
+	hugePagesUsed = false;
+}
+
+// Maps a new slab
+void Chip8Arena::allocateSlab()
+{
+	Slab slab;
+	slab.size = SLAB_SIZE;
+	slab.hugePages = false;
+	slab.memory = allocatePages(slab.size, hugePages, slab.hugePages);
+	if (slab.memory == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+
+	hugePagesUsed = hugePagesUsed || slab.hugePages;
+	slabs.push_back(slab);
+}
+
+// Maps zeroed, page-aligned memory. Huge pages are tried first if requested
+// and silently replaced by normal pages if the system can't provide them.
+void *Chip8Arena::allocatePages(size_t size, bool hugePages, bool &hugePagesUsed)
+{
+	hugePagesUsed = false;
+
+#ifdef _WIN32
+	if (hugePages)
+	{
+		// Requires the "Lock pages in memory" privilege
+		SIZE_T largePage = GetLargePageMinimum();
+		if (largePage != 0 && size % largePage == 0)
+		{
+			void *memory = VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+			if (memory != nullptr)
+			{
+				hugePagesUsed = true;
+				return memory;
+			}
+		}
+	}
+	return VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+	if (hugePages)
+	{
+#ifdef MAP_HUGETLB
+		void *memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		if (memory != MAP_FAILED)
+		{
+			hugePagesUsed = true;
+			return memory;
+		}
+#endif
+	}
+
+	void *memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (memory == MAP_FAILED)
+	{
+		return nullptr;
+	}
+#ifdef MADV_HUGEPAGE
+	if (hugePages)
+	{
+		// Fall back to transparent huge pages
+		hugePagesUsed = madvise(memory, size, MADV_HUGEPAGE) == 0;
+	}
+#endif
+	return memory;
+#endif
+}
+
+// Unmaps memory returned by allocatePages
+void Chip8Arena::freePages(void *memory, size_t size)
+{
+#ifdef _WIN32
+	(void)size;
+	VirtualFree(memory, 0, MEM_RELEASE);
+#else
+	munmap(memory, size);
+#endif
+}
@@ -0,0 +1,61 @@
+/**
+ *	@file	chip8_arena.h
+ *	@author	Dejan Azinovic (dazinovic)
+ *	@date	18.10.2026
+ *
+ *	Header file for the Chip8Arena class. The class creates large numbers of
+ *	Chip8 instances in page-aligned slabs. Instances are copy-constructed
+ *	from a template state image (usually an instance that already loaded its
+ *	application) instead of running through the constructor, so every byte
+ *	of an instance is written exactly once. Slabs can optionally be backed by
+ *	huge pages.
+ */
+
+#ifndef CHIP8_ARENA
+#define CHIP8_ARENA
+
+#include "chip8.h"
+#include <cstddef>
+#include <vector>
+
+class Chip8Arena {
+	public:
+		Chip8Arena(bool hugePages = false);
+		~Chip8Arena();
+
+		const static size_t SLAB_SIZE = 2 * 1024 * 1024;	// Size of one slab (one huge page on x86).
+
+		Chip8 *Create(const Chip8 &image);					// Creates one instance as a copy of the image.
+		void Create(const Chip8 &image, size_t count);		// Creates count instances as copies of the image.
+		void Reset(const Chip8 &image);						// Resets every instance to the image.
+		void Clear();										// Destroys all instances and releases the slabs.
+
+		size_t GetCount() const { return count; }
+		bool UsesHugePages() const { return hugePagesUsed; }	// Whether at least one slab is backed by huge pages.
+		Chip8 &operator[](size_t index) { return *instance(index); }
+
+	private:
+		Chip8Arena(const Chip8Arena &);
+		Chip8Arena &operator=(const Chip8Arena &);
+
+		struct Slab
+		{
+			void   *memory;		// Page-aligned slab memory.
+			size_t size;		// Size of the mapping.
+			bool   hugePages;	// Whether the slab is backed by huge pages.
+		};
+
+		std::vector<Slab> slabs;
+		size_t count;				// Number of instances.
+		size_t instancesPerSlab;
+		bool   hugePages;			// Whether huge pages were requested.
+		bool   hugePagesUsed;
+
+		Chip8 *instance(size_t index) const { return static_cast<Chip8 *>(slabs[index / instancesPerSlab].memory) + index % instancesPerSlab; }
+		void allocateSlab();
+
+		static void *allocatePages(size_t size, bool hugePages, bool &hugePagesUsed);
+		static void freePages(void *memory, size_t size);
+};
+
+#endif
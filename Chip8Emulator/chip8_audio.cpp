@@ -0,0 +1,439 @@
+/**
+ *	@file	chip8_audio.cpp
+ *	@author	Dejan Azinovic (dazinovic)
+ *	@date	18.10.2026
+ *
+ *	Contains an implementation of all methods from the chip8_audio header.
+ */
+
+#include "chip8_audio.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <mmsystem.h>
+#endif
+
+// 2^(i / 48) in 16.16 fixed point, the fractional octave steps of the
+// XO-CHIP pitch register
+static const unsigned int pitchTable[48] =
+{
+	65536, 66489, 67456, 68438, 69433, 70443, 71468, 72507,
+	73562, 74632, 75717, 76819, 77936, 79069, 80220, 81386,
+	82570, 83771, 84990, 86226, 87480, 88752, 90043, 91353,
+	92682, 94030, 95398, 96785, 98193, 99621, 101070, 102540,
+	104032, 105545, 107080, 108638, 110218, 111821, 113448, 115098,
+	116772, 118470, 120194, 121942, 123715, 125515, 127341, 129193
+};
+
+// Writes a little-endian integer of the given size
+static void writeLittleEndian(std::ofstream &out, unsigned int value, unsigned int bytes)
+{
+	for (unsigned int i = 0; i < bytes; i++)
+	{
+		out.put(char((value >> (8 * i)) & 0xFF));
+	}
+}
+
+// Creates the file and writes a header for an empty stream
+bool Chip8WavBackend::Open(unsigned int sampleRate)
+{
+	out.open(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!out.good())
+	{
+		return false;
+	}
+
+	dataSize = 0;
+	writeHeader(sampleRate);
+	return true;
+}
+
+// Appends samples to the file
+void Chip8WavBackend::Write(const short *samples, size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		writeLittleEndian(out, (unsigned short)samples[i], 2);
+	}
+	dataSize += (unsigned int)(2 * count);
+}
+
+// Fills in the sizes in the header and closes the file
+void Chip8WavBackend::Close()
+{
+	if (!out.is_open())
+	{
+		return;
+	}
+
+	out.seekp(4, std::ios::beg);
+	writeLittleEndian(out, 36 + dataSize, 4);
+	out.seekp(40, std::ios::beg);
+	writeLittleEndian(out, dataSize, 4);
+	out.close();
+}
+
+// Writes the RIFF header of a 16-bit mono PCM file
+void Chip8WavBackend::writeHeader(unsigned int sampleRate)
+{
+	out.write("RIFF", 4);
+	writeLittleEndian(out, 36, 4);				// Size of the rest of the file (patched on close)
+	out.write("WAVEfmt ", 8);
+	writeLittleEndian(out, 16, 4);				// Size of the format chunk
+	writeLittleEndian(out, 1, 2);				// PCM
+	writeLittleEndian(out, 1, 2);				// Mono
+	writeLittleEndian(out, sampleRate, 4);
+	writeLittleEndian(out, 2 * sampleRate, 4);	// Bytes per second
+	writeLittleEndian(out, 2, 2);				// Bytes per sample
+	writeLittleEndian(out, 16, 2);				// Bits per sample
+	out.write("data", 4);
+	writeLittleEndian(out, 0, 4);				// Size of the sample data (patched on close)
+}
+
+// Starts a new stream
+bool Chip8NullBackend::Open(unsigned int)
+{
+	sampleCount = 0;
+	hash = 14695981039346656037ull;
+	return true;
+}
+
+// Counts and hashes samples
+void Chip8NullBackend::Write(const short *samples, size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		unsigned short sample = (unsigned short)samples[i];
+		hash = (hash ^ (sample & 0xFF)) * 1099511628211ull;
+		hash = (hash ^ (sample >> 8)) * 1099511628211ull;
+	}
+	sampleCount += count;
+}
+
+#if defined(_WIN32)
+struct Chip8WaveOutBackend::Device
+{
+	HWAVEOUT                        handle;
+	HANDLE                          returned;	// Signalled whenever the device returns a buffer.
+	std::vector<WAVEHDR>            headers;
+	std::vector<std::vector<short>> buffers;
+	unsigned int                    next;		// Buffer the next period goes into.
+};
+
+Chip8WaveOutBackend::Chip8WaveOutBackend(size_t period, unsigned int bufferCount) : period(period), bufferCount(bufferCount)
+{
+}
+
+Chip8WaveOutBackend::~Chip8WaveOutBackend()
+{
+	Close();
+}
+
+// Opens the default sound device for 16-bit mono samples and prepares the
+// buffers. All of them start out free.
+bool Chip8WaveOutBackend::Open(unsigned int sampleRate)
+{
+	WAVEFORMATEX format = {};
+	format.wFormatTag = WAVE_FORMAT_PCM;
+	format.nChannels = 1;
+	format.nSamplesPerSec = sampleRate;
+	format.nAvgBytesPerSec = 2 * sampleRate;
+	format.nBlockAlign = 2;
+	format.wBitsPerSample = 16;
+
+	std::unique_ptr<Device> opened(new Device);
+	opened->returned = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+	if (opened->returned == nullptr)
+	{
+		return false;
+	}
+	if (waveOutOpen(&opened->handle, WAVE_MAPPER, &format, (DWORD_PTR)opened->returned, 0, CALLBACK_EVENT) != MMSYSERR_NOERROR)
+	{
+		CloseHandle(opened->returned);
+		return false;
+	}
+
+	opened->headers.assign(bufferCount, WAVEHDR());
+	opened->buffers.assign(bufferCount, std::vector<short>(period));
+	opened->next = 0;
+	for (unsigned int i = 0; i < bufferCount; i++)
+	{
+		WAVEHDR &header = opened->headers[i];
+		header.lpData = reinterpret_cast<LPSTR>(opened->buffers[i].data());
+		header.dwBufferLength = DWORD(2 * period);
+		waveOutPrepareHeader(opened->handle, &header, sizeof(WAVEHDR));
+		header.dwFlags |= WHDR_DONE;
+	}
+
+	device = std::move(opened);
+	return true;
+}
+
+// Queues a period, waiting for a free buffer if all of them are queued
+void Chip8WaveOutBackend::Write(const short *samples, size_t count)
+{
+	WAVEHDR &header = device->headers[device->next];
+	while ((header.dwFlags & WHDR_DONE) == 0)
+	{
+		WaitForSingleObject(device->returned, INFINITE);
+	}
+
+	count = std::min(count, period);
+	memcpy(header.lpData, samples, 2 * count);
+	header.dwBufferLength = DWORD(2 * count);
+	header.dwFlags &= ~WHDR_DONE;
+	waveOutWrite(device->handle, &header, sizeof(WAVEHDR));
+	device->next = (device->next + 1) % bufferCount;
+}
+
+// Lets the device play the queued buffers and closes it
+void Chip8WaveOutBackend::Close()
+{
+	if (!device)
+	{
+		return;
+	}
+
+	for (unsigned int i = 0; i < bufferCount; i++)
+	{
+		WAVEHDR &header = device->headers[i];
+		while ((header.dwFlags & WHDR_DONE) == 0)
+		{
+			WaitForSingleObject(device->returned, INFINITE);
+		}
+		waveOutUnprepareHeader(device->handle, &header, sizeof(WAVEHDR));
+	}
+	waveOutClose(device->handle);
+	CloseHandle(device->returned);
+	device.reset();
+}
+#endif
+
+Chip8Audio::Chip8Audio(Chip8AudioBackend &backend, unsigned int sampleRate, unsigned int cycleRate, size_t bufferSize) :
+	backend(backend), sampleRate(sampleRate), cycleRate(cycleRate), baseCycle(0), baseSample(0), lastCycle(0), frequency(440), volume(8192), muted(false),
+	position(0), phase(0), on(false), block(512), patternMode(false), patternPhase(0), patternStep(0),
+	ring(bufferSize), running(false), started(false), underruns(0), overruns(0)
+{
+	memset(patternBits, 0, sizeof(patternBits));
+	setPitch(64);
+}
+
+Chip8Audio::~Chip8Audio()
+{
+	Stop();
+}
+
+// Records sound events. They get the sample of their cycle when they are
+// synthesized.
+void Chip8Audio::Push(const Chip8Event &event)
+{
+	switch (event.type)
+	{
+	case Chip8EventType::SoundStart:
+	case Chip8EventType::SoundStop:
+	case Chip8EventType::AudioPattern:
+	case Chip8EventType::AudioPitch:
+		transitions.push_back(event);
+		break;
+	default:
+		break;
+	}
+}
+
+// Synthesizes all samples up to the emulated cycle
+void Chip8Audio::Advance(unsigned long long cycle)
+{
+	unsigned long long end = sampleAt(cycle);
+
+	size_t consumed = 0;
+	for (; consumed < transitions.size() && sampleAt(transitions[consumed].cycle) < end; consumed++)
+	{
+		synthesize(sampleAt(transitions[consumed].cycle));
+		apply(transitions[consumed]);
+	}
+	transitions.erase(transitions.begin(), transitions.begin() + consumed);
+
+	synthesize(end);
+	lastCycle = cycle;
+}
+
+// Changes the cycle rate from the cycle of the last Advance on. Pending
+// events are placed at the new rate, as they only get their sample when
+// they are synthesized.
+void Chip8Audio::SetCycleRate(unsigned int cycleRate)
+{
+	baseSample = sampleAt(lastCycle);
+	baseCycle = lastCycle;
+	this->cycleRate = cycleRate;
+}
+
+// Applies a sound event at the current position
+void Chip8Audio::apply(const Chip8Event &event)
+{
+	switch (event.type)
+	{
+	case Chip8EventType::SoundStart:
+		if (!on)
+		{
+			phase = 0;
+			patternPhase = 0;
+		}
+		on = true;
+		break;
+	case Chip8EventType::SoundStop:
+		on = false;
+		break;
+	case Chip8EventType::AudioPattern:
+		for (unsigned int i = 0; i < 128; i++)
+		{
+			patternBits[i] = (event.payload[i / 8] >> (7 - i % 8)) & 1;
+		}
+		patternMode = true;
+		break;
+	case Chip8EventType::AudioPitch:
+		setPitch((unsigned char)event.data);
+		break;
+	default:
+		break;
+	}
+}
+
+// Computes how many pattern bits play per host sample. The pattern rate is
+// 4000 * 2^((pitch - 64) / 48) bits per second.
+void Chip8Audio::setPitch(unsigned char pitch)
+{
+	int steps = int(pitch) - 64;
+	int octave = (steps >= 0) ? steps / 48 : -((47 - steps) / 48);
+	unsigned long long rate = 4000ull * pitchTable[steps - 48 * octave];	// 16.16 fixed point
+	rate = (octave >= 0) ? rate << octave : rate >> -octave;
+	patternStep = (rate << 16) / sampleRate;
+}
+
+// Synthesizes samples up to end with the beeper state fixed. The phase is
+// an integer accumulator, so the output only depends on the events.
+void Chip8Audio::synthesize(unsigned long long end)
+{
+	while (position < end)
+	{
+		size_t count = (size_t)std::min<unsigned long long>(end - position, block.size());
+		if (on && patternMode && !muted.load(std::memory_order_relaxed))
+		{
+			// Nearest-neighbour resampling. Every sample only depends on its
+			// index, so the loop carries no dependency and vectorizes.
+			unsigned long long start = patternPhase;
+			unsigned long long step = patternStep;
+			int level = volume;
+			for (size_t i = 0; i < count; i++)
+			{
+				block[i] = short((2 * patternBits[((start + i * step) >> 32) & 127] - 1) * level);
+			}
+			patternPhase = start + count * step;
+		}
+		else if (on && !muted.load(std::memory_order_relaxed))
+		{
+			for (size_t i = 0; i < count; i++)
+			{
+				block[i] = (phase < sampleRate / 2) ? volume : -volume;
+				phase += frequency;
+				if (phase >= sampleRate)
+				{
+					phase -= sampleRate;
+				}
+			}
+		}
+		else
+		{
+			std::fill(block.begin(), block.begin() + count, short(0));
+		}
+
+		if (!backend.IsRealTime())
+		{
+			if (started)
+			{
+				backend.Write(block.data(), count);
+			}
+		}
+		else
+		{
+			size_t pushed = ring.Push(block.data(), count);
+			if (pushed < count)
+			{
+				overruns.fetch_add(count - pushed, std::memory_order_relaxed);
+			}
+		}
+		position += count;
+	}
+}
+
+// Opens the backend and starts the backend thread of a real-time backend
+bool Chip8Audio::Start()
+{
+	if (started)
+	{
+		return true;
+	}
+	if (!backend.Open(sampleRate))
+	{
+		return false;
+	}
+
+	started = true;
+	if (backend.IsRealTime())
+	{
+		running.store(true);
+		thread = std::thread(&Chip8Audio::run, this);
+	}
+	return true;
+}
+
+// Plays the remaining samples, stops the backend thread and closes the backend
+void Chip8Audio::Stop()
+{
+	if (!started)
+	{
+		return;
+	}
+
+	if (running.exchange(false))
+	{
+		thread.join();
+	}
+	backend.Close();
+	started = false;
+}
+
+// Backend thread loop of a real-time backend. The backend gets one period
+// per period length, padded with silence if the emulator fell behind.
+void Chip8Audio::run()
+{
+	std::vector<short> period(backend.GetPeriod());
+	std::chrono::steady_clock::duration length = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+		std::chrono::duration<double>(double(period.size()) / sampleRate));
+	std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now();
+
+	while (running.load())
+	{
+		size_t count = ring.Pop(period.data(), period.size());
+		if (count < period.size())
+		{
+			std::fill(period.begin() + count, period.end(), short(0));
+			underruns.fetch_add(1, std::memory_order_relaxed);
+		}
+		backend.Write(period.data(), period.size());
+
+		next += length;
+		std::this_thread::sleep_until(next);
+	}
+
+	size_t count;
+	while ((count = ring.Pop(period.data(), period.size())) > 0)
+	{
+		backend.Write(period.data(), count);
+	}
+}
@@ -0,0 +1,186 @@
+/**
+ *	@file	chip8_audio.h
+ *	@author	Dejan Azinovic (dazinovic)
+ *	@date	18.10.2026
+ *
+ *	Header file for the Chip8Audio class and its backends. Chip8Audio is an
+ *	event sink that turns the sound events of an emulator into a square wave.
+ *	Sound events carry the emulated cycle they happened at, so the beeper
+ *	starts and stops on the exact sample that corresponds to that cycle, no
+ *	matter how the host batches the emulation.
+ *
+ *	Once an application loads an XO-CHIP audio pattern (F002), the pattern
+ *	replaces the beeper: its 128 bits are played in a loop at the rate set by
+ *	the pitch register (FX3A) and resampled to the host rate. All of the
+ *	synthesis uses integer arithmetic, so the stream only depends on the
+ *	events and can be hashed for regression tests.
+ *
+ *	The emulation thread synthesizes samples up to the current cycle with
+ *	Advance. For real-time backends (sound devices), the samples go into a
+ *	lock-free ring buffer that a backend thread drains once per period. If
+ *	the ring buffer is full, samples are dropped rather than stalling the
+ *	emulator; if the backend runs out of samples, silence is played instead.
+ *	Both are counted. On Windows, Chip8WaveOutBackend plays the stream on
+ *	the default sound device.
+ *
+ *	Other backends get the samples directly from Advance, so they receive
+ *	the complete stream no matter how fast the emulator runs.
+ *	Chip8WavBackend writes the stream to a WAV file and Chip8NullBackend
+ *	discards it while keeping a hash, which allows headless testing.
+ *
+ *	Cycles are converted to samples at the cycle rate of the emulator, which
+ *	may change while it runs (SetCycleRate); the stream continues seamlessly
+ *	at the new rate.
+ */
+
+#ifndef CHIP8_AUDIO
+#define CHIP8_AUDIO
+
+#include "chip8_events.h"
+#include "chip8_queue.h"
+#include <atomic>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Plays (or stores) a stream of signed 16-bit mono samples
+class Chip8AudioBackend {
+	public:
+		virtual ~Chip8AudioBackend() {}
+
+		virtual bool Open(unsigned int sampleRate) = 0;				// Called before the first samples.
+		virtual void Write(const short *samples, size_t count) = 0;	// Called on the backend thread (real-time) or in Advance.
+		virtual void Close() = 0;									// Called after the last samples.
+
+		virtual bool IsRealTime() const { return false; }			// Whether samples are consumed at the sample rate rather than as fast as they come.
+		virtual size_t GetPeriod() const { return 512; }			// Number of samples the backend takes at once.
+};
+
+// Writes the stream to a 16-bit mono WAV file
+class Chip8WavBackend : public Chip8AudioBackend {
+	public:
+		Chip8WavBackend(const std::string &filename) : filename(filename), dataSize(0) {}
+
+		bool Open(unsigned int sampleRate) override;
+		void Write(const short *samples, size_t count) override;
+		void Close() override;
+
+	private:
+		std::string   filename;
+		std::ofstream out;
+		unsigned int  dataSize;		// Bytes of sample data written so far.
+
+		void writeHeader(unsigned int sampleRate);
+};
+
+#if defined(_WIN32)
+// Plays the stream on the default sound device with the Windows multimedia
+// API. Every period goes into one of a few device buffers; once all of them
+// are queued, Write waits for the device to return one.
+class Chip8WaveOutBackend : public Chip8AudioBackend {
+	public:
+		Chip8WaveOutBackend(size_t period = 512, unsigned int bufferCount = 4);
+		~Chip8WaveOutBackend();
+
+		bool Open(unsigned int sampleRate) override;
+		void Write(const short *samples, size_t count) override;
+		void Close() override;
+
+		bool IsRealTime() const override { return true; }
+		size_t GetPeriod() const override { return period; }
+
+	private:
+		Chip8WaveOutBackend(const Chip8WaveOutBackend &);
+		Chip8WaveOutBackend &operator=(const Chip8WaveOutBackend &);
+
+		struct Device;					// Keeps windows.h out of this header.
+
+		size_t                  period;			// Samples per device buffer.
+		unsigned int            bufferCount;	// Device buffers queued at most.
+		std::unique_ptr<Device> device;			// Open device, or null.
+};
+#endif
+
+// Discards the stream, but counts and hashes the samples
+class Chip8NullBackend : public Chip8AudioBackend {
+	public:
+		Chip8NullBackend() : sampleCount(0), hash(0) {}
+
+		bool Open(unsigned int sampleRate) override;
+		void Write(const short *samples, size_t count) override;
+		void Close() override {}
+
+		unsigned long long GetSampleCount() const { return sampleCount; }
+		unsigned long long GetHash() const { return hash; }		// FNV-1a hash of the stream.
+
+	private:
+		unsigned long long sampleCount;
+		unsigned long long hash;
+};
+
+class Chip8Audio : public Chip8EventSink {
+	public:
+		Chip8Audio(Chip8AudioBackend &backend, unsigned int sampleRate = 44100, unsigned int cycleRate = 60, size_t bufferSize = 8192);
+		~Chip8Audio();
+
+		void Push(const Chip8Event &event) override;		// Emulation thread: records sound starts and stops.
+		void Advance(unsigned long long cycle);				// Emulation thread: synthesizes all samples up to the emulated cycle.
+
+		bool Start();										// Opens the backend and starts the backend thread of a real-time backend.
+		void Stop();										// Plays the remaining samples, stops the backend thread and closes the backend.
+
+		void SetFrequency(unsigned int frequency) { this->frequency = frequency; }	// Pitch of the beeper in Hz.
+		void SetVolume(short volume) { this->volume = volume; }						// Amplitude of the square wave.
+		void SetCycleRate(unsigned int cycleRate);										// Emulation thread: emulated cycles per second from the last Advance on.
+		void ToggleSound() { muted = !muted; }											// Toggles sound off or on.
+
+		unsigned int GetSampleRate() const { return sampleRate; }
+		unsigned long long GetUnderruns() const { return underruns.load(std::memory_order_relaxed); }	// Periods a real-time backend had to be padded with silence.
+		unsigned long long GetOverruns() const { return overruns.load(std::memory_order_relaxed); }		// Samples dropped because the ring buffer was full.
+		size_t GetBufferedSamples() const { return ring.GetSize(); }									// Samples waiting for the backend.
+		double GetLatency() const { return double(ring.GetSize()) / sampleRate; }						// Seconds between synthesis and playback.
+
+	private:
+		Chip8Audio(const Chip8Audio &);
+		Chip8Audio &operator=(const Chip8Audio &);
+
+		Chip8AudioBackend &backend;
+		unsigned int sampleRate;			// Samples per second.
+		unsigned int cycleRate;				// Emulated cycles per second.
+		unsigned long long baseCycle;		// Cycle the cycle rate was last set at.
+		unsigned long long baseSample;		// Sample of baseCycle.
+		unsigned long long lastCycle;		// Cycle of the last Advance.
+		unsigned int frequency;
+		short        volume;
+		std::atomic<bool> muted;
+
+		// Synthesis state (emulation thread)
+		std::vector<Chip8Event> transitions;	// Pending sound events, in order.
+		unsigned long long position;			// Next sample to synthesize.
+		unsigned long long phase;				// Position within the square wave period (0 to sampleRate, advances by frequency per sample).
+		bool               on;					// Whether the sound is on at position.
+		std::vector<short> block;				// Scratch space for synthesized samples.
+
+		// XO-CHIP pattern playback
+		bool               patternMode;			// Whether an application loaded an audio pattern.
+		unsigned char      patternBits[128];	// Pattern with one byte (0 or 1) per bit.
+		unsigned long long patternPhase;		// Position within the pattern in bits (32.32 fixed point).
+		unsigned long long patternStep;			// Pattern bits per host sample (32.32 fixed point).
+
+		Chip8Queue<short> ring;					// Samples between the emulation and the backend thread.
+		std::thread       thread;
+		std::atomic<bool> running;
+		bool              started;
+		std::atomic<unsigned long long> underruns;
+		std::atomic<unsigned long long> overruns;
+
+		unsigned long long sampleAt(unsigned long long cycle) const { return baseSample + (cycle > baseCycle ? (cycle - baseCycle) * sampleRate / cycleRate : 0); }
+		void apply(const Chip8Event &event);		// Applies a sound event at the current position.
+		void synthesize(unsigned long long end);	// Synthesizes samples up to end with the sound state fixed.
+		void setPitch(unsigned char pitch);
+		void run();									// Backend thread loop.
+};
+
+#endif
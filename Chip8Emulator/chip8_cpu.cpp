@@ -0,0 +1,147 @@
+/**
+ *	@file	chip8_cpu.cpp
+ *	@author	Dejan Azinovic (dazinovic)
+ *	@date	18.10.2026
+ *
+ *	Contains an implementation of all methods from the chip8_cpu header.
+ */
+
+#include "chip8_cpu.h"
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(CHIP8_SIMD_X86)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+// Reads the instruction set limit from the environment
+static Chip8Simd environmentLimit()
+{
+	Chip8Simd simd = Chip8Simd::Avx512;
+#if defined(_MSC_VER)
+	char *value = nullptr;
+	size_t length = 0;
+	if (_dupenv_s(&value, &length, "CHIP8_SIMD") == 0 && value != nullptr)
+	{
+		Chip8Cpu::ParseSimd(value, simd);
+		free(value);
+	}
+#else
+	const char *value = getenv("CHIP8_SIMD");
+	if (value != nullptr)
+	{
+		Chip8Cpu::ParseSimd(value, simd);
+	}
+#endif
+	return simd;
+}
+
+// Limit set by LimitSimd or the environment
+static std::atomic<unsigned char> &simdLimit()
+{
+	static std::atomic<unsigned char> limit(static_cast<unsigned char>(environmentLimit()));
+	return limit;
+}
+
+// Returns the best supported instruction set, detected on the first call
+Chip8Simd Chip8Cpu::GetSupportedSimd()
+{
+	static const Chip8Simd supported = detect();
+	return supported;
+}
+
+// Returns the instruction set kernels should be bound to
+Chip8Simd Chip8Cpu::GetSimd()
+{
+	unsigned char supported = static_cast<unsigned char>(GetSupportedSimd());
+	unsigned char limit = simdLimit().load();
+	return static_cast<Chip8Simd>((limit < supported) ? limit : supported);
+}
+
+// Limits the instruction set of kernels bound from now on
+void Chip8Cpu::LimitSimd(Chip8Simd simd)
+{
+	simdLimit().store(static_cast<unsigned char>(simd));
+}
+
+// Returns a readable name of an instruction set
+const char *Chip8Cpu::GetSimdName(Chip8Simd simd)
+{
+	switch (simd)
+	{
+	case Chip8Simd::Scalar:	return "scalar";
+	case Chip8Simd::Sse2:	return "sse2";
+	case Chip8Simd::Avx2:	return "avx2";
+	case Chip8Simd::Avx512:	return "avx512";
+	}
+	return "unknown";
+}
+
+// Parses the name of an instruction set
+bool Chip8Cpu::ParseSimd(const char *name, Chip8Simd &simd)
+{
+	const Chip8Simd all[] = { Chip8Simd::Scalar, Chip8Simd::Sse2, Chip8Simd::Avx2, Chip8Simd::Avx512 };
+	for (Chip8Simd candidate : all)
+	{
+		if (strcmp(name, GetSimdName(candidate)) == 0)
+		{
+			simd = candidate;
+			return true;
+		}
+	}
+	return false;
+}
+
+// Detects the instruction sets. AVX2 and AVX-512 also need the operating
+// system to save the wider registers, which XGETBV reports.
+Chip8Simd Chip8Cpu::detect()
+{
+#if defined(CHIP8_SIMD_X86)
+	unsigned int leaf1[4] = {};
+	unsigned int leaf7[4] = {};
+	unsigned long long xcr0 = 0;
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	int maxLeaf = info[0];
+	__cpuid(info, 1);
+	memcpy(leaf1, info, sizeof(leaf1));
+	if (maxLeaf >= 7)
+	{
+		__cpuidex(info, 7, 0);
+		memcpy(leaf7, info, sizeof(leaf7));
+	}
+	if ((leaf1[2] & (1 << 27)) != 0)
+	{
+		xcr0 = _xgetbv(0);
+	}
+#else
+	__get_cpuid(1, &leaf1[0], &leaf1[1], &leaf1[2], &leaf1[3]);
+	__get_cpuid_count(7, 0, &leaf7[0], &leaf7[1], &leaf7[2], &leaf7[3]);
+	if ((leaf1[2] & (1 << 27)) != 0)
+	{
+		unsigned int low, high;
+		__asm__ volatile ("xgetbv" : "=a" (low), "=d" (high) : "c" (0));
+		xcr0 = (unsigned long long)high << 32 | low;
+	}
+#endif
+
+	bool avx = (leaf1[2] & (1 << 28)) != 0 && (xcr0 & 0x06) == 0x06;
+	bool avx2 = avx && (leaf7[1] & (1 << 5)) != 0;
+#if defined(CHIP8_SIMD_AVX512)
+	if (avx2 && (xcr0 & 0xE6) == 0xE6 && (leaf7[1] & (1 << 16)) != 0 && (leaf7[1] & (1u << 30)) != 0)
+	{
+		return Chip8Simd::Avx512;
+	}
+#endif
+	return avx2 ? Chip8Simd::Avx2 : Chip8Simd::Sse2;
+#else
+	return Chip8Simd::Scalar;
+#endif
+}
@@ -0,0 +1,66 @@
+/**
+ *	@file	chip8_cpu.h
+ *	@author	Dejan Azinovic (dazinovic)
+ *	@date	18.10.2026
+ *
+ *	Header file for the Chip8Cpu class, which detects the SIMD instruction
+ *	sets of the CPU at run time. Vectorized code (Chip8Video, Chip8Lockstep)
+ *	is compiled for every instruction set and binds its kernels to the best
+ *	one the CPU supports when an object is created, so a single binary uses
+ *	AVX2 or AVX-512 where they exist and still runs on SSE2-only machines.
+ *
+ *	For benchmarks, the instruction set can be limited with LimitSimd or by
+ *	setting the environment variable CHIP8_SIMD to scalar, sse2, avx2 or
+ *	avx512. Only objects created afterwards are affected.
+ *
+ *	Kernels for an instruction set above the baseline of the build are
+ *	marked with CHIP8_TARGET_AVX2 or CHIP8_TARGET_AVX512, and the templates
+ *	they are built from with CHIP8_FORCE_INLINE. GCC and Clang only inline
+ *	code into functions compiled for the same instruction set; MSVC accepts
+ *	the intrinsics anywhere.
+ */
+
+#ifndef CHIP8_CPU
+#define CHIP8_CPU
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CHIP8_SIMD_X86
+#if !defined(_MSC_VER) || _MSC_VER >= 1911
+#define CHIP8_SIMD_AVX512		// VS2015 has no AVX-512 intrinsics.
+#endif
+#endif
+
+#if defined(_MSC_VER)
+#define CHIP8_TARGET_AVX2
+#define CHIP8_TARGET_AVX512
+#define CHIP8_FORCE_INLINE __forceinline
+#else
+#define CHIP8_TARGET_AVX2 __attribute__((target("avx2")))
+#define CHIP8_TARGET_AVX512 __attribute__((target("avx512f,avx512bw")))
+#define CHIP8_FORCE_INLINE inline __attribute__((always_inline))
+#endif
+
+// SIMD instruction sets, each one including the ones before it
+enum class Chip8Simd : unsigned char {
+	Scalar,		// Plain C++.
+	Sse2,		// 128-bit integer vectors (every x86-64 CPU).
+	Avx2,		// 256-bit integer vectors.
+	Avx512		// 512-bit integer vectors with byte and word instructions (AVX-512F and AVX-512BW).
+};
+
+class Chip8Cpu {
+	public:
+		static Chip8Simd GetSupportedSimd();		// Best instruction set of the CPU that the build has kernels for.
+		static Chip8Simd GetSimd();					// Instruction set to bind kernels to, the supported one unless limited.
+		static void LimitSimd(Chip8Simd simd);		// Binds kernels of objects created afterwards to at most the given instruction set.
+
+		static const char *GetSimdName(Chip8Simd simd);
+		static bool ParseSimd(const char *name, Chip8Simd &simd);	// Parses "scalar", "sse2", "avx2" or "avx512".
+
+	private:
+		Chip8Cpu();
+
+		static Chip8Simd detect();		// Queries cpuid and the register state the operating system saves.
+};
+
+#endif
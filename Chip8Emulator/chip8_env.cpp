@@ -0,0 +1,274 @@
+/**
+ *	@file	chip8_env.cpp
+ *	@author	Dejan Azinovic (dazinovic)
+ *	@date	18.10.2026
+ *
+ *	Contains an implementation of all methods from the chip8_env header.
+ */
+
+#include "chip8_env.h"
+#include <cstring>
+
+Chip8Environment::Chip8Environment(size_t count, unsigned int threadCount) :
+	instances(count), scores(count, 0), rewardAddress(0), rewardBytes(0), frameSkip(1), cyclesPerFrame(10), maxPool(false),
+	generation(0), busy(0), stopping(false), next(0), chunkSize(1), taskActions(nullptr), taskRewards(nullptr), taskObservations(nullptr), taskDones(nullptr)
+{
+	if (threadCount == 0)
+	{
+		threadCount = std::thread::hardware_concurrency();
+	}
+	if (threadCount > count)
+	{
+		threadCount = (unsigned int)count;
+	}
+
+	// The calling thread takes part in every task
+	for (unsigned int i = 1; i < threadCount; i++)
+	{
+		workers.push_back(std::thread(&Chip8Environment::work, this));
+	}
+
+	// A few chunks per thread balance the load without contending on next
+	size_t chunks = 4 * (workers.size() + 1);
+	chunkSize = (count + chunks - 1) / chunks;
+	if (chunkSize == 0)
+	{
+		chunkSize = 1;
+	}
+}
+
+Chip8Environment::~Chip8Environment()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	started.notify_all();
+	for (size_t i = 0; i < workers.size(); i++)
+	{
+		workers[i].join();
+	}
+}
+
+// Loads the application every instance starts from
+bool Chip8Environment::LoadApplication(const char *filename)
+{
+	Chip8 loaded;
+	if (!loaded.LoadApplication(filename))
+	{
+		return false;
+	}
+
+	image = loaded;
+	return true;
+}
+
+// Reads the score as a big-endian number of 1-4 bytes at the address
+void Chip8Environment::SetReward(unsigned short address, unsigned int bytes)
+{
+	rewardAddress = address;
+	rewardBytes = (bytes > 4) ? 4 : bytes;
+}
+
+// Emulates frameSkip frames per step, optionally max-pooling the last two
+void Chip8Environment::SetFrameSkip(unsigned int frameSkip, bool maxPool)
+{
+	this->frameSkip = (frameSkip == 0) ? 1 : frameSkip;
+	this->maxPool = maxPool;
+}
+
+// Resets every instance and writes the first observations
+void Chip8Environment::Reset(unsigned char *observations)
+{
+	for (size_t i = 0; i < instances.size(); i++)
+	{
+		Reset(i, observations + i * OBSERVATION_SIZE);
+	}
+}
+
+// Resets one instance and writes its first observation. The instance shares
+// all pages with the image until it writes to them.
+void Chip8Environment::Reset(size_t index, unsigned char *observation)
+{
+	instances[index] = image.Fork();
+	scores[index] = score(instances[index]);
+	if (observation != nullptr)
+	{
+		observe(instances[index], observation);
+	}
+}
+
+// Steps every instance with one action each. Rewards, observations and
+// done flags (1 for an instance that faulted) are only written if their
+// buffer isn't null.
+void Chip8Environment::Step(const unsigned short *actions, float *rewards, unsigned char *observations, unsigned char *dones)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		taskActions = actions;
+		taskRewards = rewards;
+		taskObservations = observations;
+		taskDones = dones;
+		next.store(0, std::memory_order_relaxed);
+		busy = (unsigned int)workers.size();
+		++generation;
+	}
+	started.notify_all();
+
+	run();
+
+	std::unique_lock<std::mutex> lock(mutex);
+	finished.wait(lock, [this] { return busy == 0; });
+}
+
+// Writes the current screens of every instance
+void Chip8Environment::Observe(unsigned char *observations) const
+{
+	for (size_t i = 0; i < instances.size(); i++)
+	{
+		observe(instances[i], observations + i * OBSERVATION_SIZE);
+	}
+}
+
+// Steps chunks of instances until all are claimed
+void Chip8Environment::run()
+{
+	size_t count = instances.size();
+	for (;;)
+	{
+		size_t begin = next.fetch_add(chunkSize, std::memory_order_relaxed);
+		if (begin >= count)
+		{
+			return;
+		}
+
+		size_t end = (begin + chunkSize < count) ? begin + chunkSize : count;
+		for (size_t i = begin; i < end; i++)
+		{
+			step(i, taskActions[i],
+				(taskRewards != nullptr) ? &taskRewards[i] : nullptr,
+				(taskObservations != nullptr) ? taskObservations + i * OBSERVATION_SIZE : nullptr,
+				(taskDones != nullptr) ? &taskDones[i] : nullptr);
+		}
+	}
+}
+
+// Worker thread loop
+void Chip8Environment::work()
+{
+	unsigned int seen = 0;
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			started.wait(lock, [this, seen] { return stopping || generation != seen; });
+			if (stopping)
+			{
+				return;
+			}
+			seen = generation;
+		}
+
+		run();
+
+		std::lock_guard<std::mutex> lock(mutex);
+		if (--busy == 0)
+		{
+			finished.notify_one();
+		}
+	}
+}
+
+// Emulates frameSkip frames of one instance with the action held. A
+// faulted instance doesn't run any more, so its frames are identical.
+void Chip8Environment::step(size_t index, unsigned short action, float *reward, unsigned char *observation, unsigned char *done)
+{
+	Chip8 &chip8 = instances[index];
+	for (unsigned int key = 0; key < ACTION_COUNT; key++)
+	{
+		chip8.keys[key] = (action >> key) & 1;
+	}
+
+	for (unsigned int frame = 0; frame < frameSkip; frame++)
+	{
+		// Keep the second to last frame for max-pooling
+		if (observation != nullptr && maxPool && frameSkip > 1 && frame == frameSkip - 1)
+		{
+			observe(chip8, observation);
+		}
+		chip8.RunFrame(cyclesPerFrame);
+	}
+
+	if (observation != nullptr)
+	{
+		if (maxPool && frameSkip > 1)
+		{
+			maxPoolObserve(chip8, observation);
+		}
+		else
+		{
+			observe(chip8, observation);
+		}
+	}
+
+	unsigned int current = score(chip8);
+	if (reward != nullptr)
+	{
+		*reward = float(current) - float(scores[index]);
+	}
+	scores[index] = current;
+
+	if (done != nullptr)
+	{
+		*done = IsDone(index) ? 1 : 0;
+	}
+}
+
+// Reads the score of an instance
+unsigned int Chip8Environment::score(const Chip8 &chip8) const
+{
+	unsigned int value = 0;
+	for (unsigned int i = 0; i < rewardBytes; i++)
+	{
+		value = value << 8 | chip8.ReadMemory(rewardAddress + i);
+	}
+	return value;
+}
+
+// Copies the screen of an instance into an observation, one color (bit i
+// from plane i) per pixel. Low resolution pixels are doubled, so
+// observations always have the high resolution size.
+void Chip8Environment::observe(const Chip8 &chip8, unsigned char *observation)
+{
+	unsigned int shift = (chip8.GetScreenWidth() < Chip8::SCREEN_WIDTH) ? 1 : 0;
+	for (unsigned int y = 0; y < Chip8::SCREEN_HEIGHT; y++)
+	{
+		const unsigned char *row = chip8.GetScreenRow(y >> shift, 0);
+		const unsigned char *plane = chip8.GetScreenRow(y >> shift, 1);
+		unsigned char *pixels = observation + y * Chip8::SCREEN_WIDTH;
+		for (unsigned int x = 0; x < Chip8::SCREEN_WIDTH; x++)
+		{
+			unsigned int column = x >> shift;
+			pixels[x] = ((row[column / 8] >> (7 - column % 8)) & 1) | ((plane[column / 8] >> (7 - column % 8)) & 1) << 1;
+		}
+	}
+}
+
+// Combines the screen of an instance with the previous frame in the
+// observation. Pixels are 0 or 1 per plane, so the maximum is a bitwise or
+// (of every plane).
+void Chip8Environment::maxPoolObserve(const Chip8 &chip8, unsigned char *observation)
+{
+	unsigned int shift = (chip8.GetScreenWidth() < Chip8::SCREEN_WIDTH) ? 1 : 0;
+	for (unsigned int y = 0; y < Chip8::SCREEN_HEIGHT; y++)
+	{
+		const unsigned char *row = chip8.GetScreenRow(y >> shift, 0);
+		const unsigned char *plane = chip8.GetScreenRow(y >> shift, 1);
+		unsigned char *pooled = observation + y * Chip8::SCREEN_WIDTH;
+		for (unsigned int x = 0; x < Chip8::SCREEN_WIDTH; x++)
+		{
+			unsigned int column = x >> shift;
+			pooled[x] |= ((row[column / 8] >> (7 - column % 8)) & 1) | ((plane[column / 8] >> (7 - column % 8)) & 1) << 1;
+		}
+	}
+}
@@ -0,0 +1,96 @@
+/**
+ *	@file	chip8_env.h
+ *	@author	Dejan Azinovic (dazinovic)
+ *	@date	18.10.2026
+ *
+ *	Header file for the Chip8Environment class. The class wraps a batch of
+ *	Chip8 instances as a reinforcement learning environment with the usual
+ *	Reset / Step / Observe interface. An action is a bit mask of the 16 keys
+ *	that are held down, an observation is the screen of an instance (one byte
+ *	per pixel holding its color, at 128x64 in either resolution) and the
+ *	reward is the change of a score the application keeps at a fixed memory
+ *	address. An instance is done once it faulted (an illegal opcode or a
+ *	trapped access); it stays on its last observation until it is reset.
+ *
+ *	Every step emulates frameSkip frames per instance with the action held.
+ *	With max-pooling enabled, the observation is the pixel-wise maximum of
+ *	the last two frames, which hides sprites that the application draws on
+ *	every other frame. Instances are stepped in parallel on a thread pool and
+ *	write their observations straight into the buffer of the caller, which
+ *	must hold GetCount() * OBSERVATION_SIZE bytes.
+ */
+
+#ifndef CHIP8_ENV
+#define CHIP8_ENV
+
+#include "chip8.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class Chip8Environment {
+	public:
+		Chip8Environment(size_t count, unsigned int threadCount = 0);	// A thread count of 0 uses one thread per hardware thread.
+		~Chip8Environment();
+
+		const static unsigned int OBSERVATION_SIZE = Chip8::SCREEN_WIDTH * Chip8::SCREEN_HEIGHT;	// Bytes per observation.
+		const static unsigned int ACTION_COUNT     = 16;												// Number of keys an action can hold.
+
+		bool LoadApplication(const char *filename);							// Load the application every instance starts from.
+		void SetReward(unsigned short address, unsigned int bytes = 1);		// Read the score as a big-endian number of 1-4 bytes at the address.
+		void SetFrameSkip(unsigned int frameSkip, bool maxPool = false);	// Emulate frameSkip frames per step, optionally max-pooling the last two.
+		void SetCyclesPerFrame(unsigned int cycles) { cyclesPerFrame = cycles; }
+
+		void Reset(unsigned char *observations);											// Reset every instance and write the first observations.
+		void Reset(size_t index, unsigned char *observation);								// Reset one instance and write its first observation.
+		void Step(const unsigned short *actions, float *rewards, unsigned char *observations, unsigned char *dones = nullptr);	// Step every instance with one action each.
+		void Observe(unsigned char *observations) const;									// Write the current screens of every instance.
+
+		bool IsDone(size_t index) const { return instances[index].GetFault() != Chip8Fault::None; }	// Whether an instance faulted and must be reset.
+		size_t GetCount() const { return instances.size(); }
+		unsigned int GetThreadCount() const { return (unsigned int)workers.size() + 1; }
+		Chip8 &operator[](size_t index) { return instances[index]; }
+
+	private:
+		Chip8Environment(const Chip8Environment &);
+		Chip8Environment &operator=(const Chip8Environment &);
+
+		Chip8 image;						// State every instance is reset to.
+		std::vector<Chip8> instances;
+		std::vector<unsigned int> scores;	// Score of every instance after its last step.
+
+		unsigned short rewardAddress;
+		unsigned int   rewardBytes;		// 0 if no reward address was set.
+		unsigned int   frameSkip;
+		unsigned int   cyclesPerFrame;
+		bool           maxPool;
+
+		// Thread pool
+		std::vector<std::thread> workers;
+		std::mutex               mutex;
+		std::condition_variable  started;	// Signalled when a new task is available.
+		std::condition_variable  finished;	// Signalled when the last worker finished a task.
+		unsigned int             generation;	// Incremented for every task.
+		unsigned int             busy;			// Number of workers still working on the task.
+		bool                     stopping;
+		std::atomic<size_t>      next;			// First instance of the next unclaimed chunk.
+		size_t                   chunkSize;
+
+		const unsigned short *taskActions;	// Arguments of the current task.
+		float                *taskRewards;
+		unsigned char        *taskObservations;
+		unsigned char        *taskDones;
+
+		void run();								// Steps chunks of instances until all are claimed.
+		void work();							// Worker thread loop.
+		void step(size_t index, unsigned short action, float *reward, unsigned char *observation, unsigned char *done);
+		unsigned int score(const Chip8 &chip8) const;
+
+		static void observe(const Chip8 &chip8, unsigned char *observation);
+		static void maxPoolObserve(const Chip8 &chip8, unsigned char *observation);
+};
+
+#endif
@@ -0,0 +1,115 @@
+/**
+ *	@file	chip8_events.cpp
+ *	@author	Dejan Azinovic (dazinovic)
+ *	@date	18.10.2026
+ *
+ *	Contains an implementation of all methods from the chip8_events header.
+ */
+
+#include "chip8_events.h"
+#include "chip8_access.h"
+#include <chrono>
+
+// Queues an event, dropping it if the queue is full
+void Chip8EventQueue::Push(const Chip8Event &event)
+{
+	if (!queue.Push(event))
+	{
+		dropped.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+Chip8EventLogger::Chip8EventLogger(Chip8EventQueue &queue, std::ostream &out) :
+	queue(queue), out(out), running(false), soundEnabled(true), logDraws(false)
+{
+}
+
+Chip8EventLogger::~Chip8EventLogger()
+{
+	Stop();
+}
+
+// Starts the logging thread
+void Chip8EventLogger::Start()
+{
+	if (!running.exchange(true))
+	{
+		thread = std::thread(&Chip8EventLogger::run, this);
+	}
+}
+
+// Logs the remaining events and stops the logging thread
+void Chip8EventLogger::Stop()
+{
+	if (running.exchange(false))
+	{
+		thread.join();
+	}
+}
+
+// Logging thread loop. Polls the queue, so the emulator never has to wake it.
+void Chip8EventLogger::run()
+{
+	while (running.load())
+	{
+		drain();
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	drain();
+}
+
+// Logs all queued events
+void Chip8EventLogger::drain()
+{
+	Chip8Event event;
+	bool logged = false;
+	while (queue.Pop(event))
+	{
+		log(event);
+		logged = true;
+	}
+	if (logged)
+	{
+		out.flush();
+	}
+}
+
+// Writes one event
+void Chip8EventLogger::log(const Chip8Event &event)
+{
+	switch (event.type)
+	{
+	case Chip8EventType::SoundStart:
+		break;
+	case Chip8EventType::SoundStop:
+		out << "BEEP!\n";
+		if (soundEnabled.load())
+		{
+			out << '\a';
+		}
+		break;
+	case Chip8EventType::Draw:
+		if (logDraws.load())
+		{
+			out << "Draw at (" << (event.data & 0xFF) << ", " << ((event.data >> 8) & 0xFF) << "), "
+				<< ((event.data >> 16) & 0xFF) << " rows" << ((event.data >> 24) != 0 ? ", collision" : "") << "\n";
+		}
+		break;
+	case Chip8EventType::AudioPattern:
+	case Chip8EventType::AudioPitch:
+		break;
+	case Chip8EventType::Fault:
+		out << "Fault at 0x" << std::hex << event.pc << std::dec << " (cycle " << event.cycle << "): "
+			<< Chip8FaultName(Chip8Fault(event.data)) << "\n";
+		break;
+	case Chip8EventType::ApplicationTooBig:
+		out << "The application is too big.\n";
+		break;
+	case Chip8EventType::ApplicationNotFound:
+		out << "Error opening application file.\n";
+		break;
+	case Chip8EventType::OutputNotWritable:
+		out << "Error opening output file.\n";
+		break;
+	}
+}
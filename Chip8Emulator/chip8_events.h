@@ -0,0 +1,111 @@
+/**
+ *	@file	chip8_events.h
+ *	@author	Dejan Azinovic (dazinovic)
+ *	@date	18.10.2026
+ *
+ *	Events the emulator reports to its host. The core never does any I/O
+ *	itself; instead, it hands events to a Chip8EventSink. Chip8EventQueue is
+ *	a sink that stores the events in a lock-free single producer, single
+ *	consumer queue, so the emulation thread never waits. Chip8EventLogger
+ *	drains such a queue on a thread of its own and writes the events to a
+ *	stream.
+ */
+
+#ifndef CHIP8_EVENTS
+#define CHIP8_EVENTS
+
+#include "chip8_queue.h"
+#include <atomic>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+enum class Chip8EventType : unsigned char {
+	SoundStart,			// The sound timer was set while it was 0.
+	SoundStop,			// The sound timer ran out (or was set to 0).
+	Draw,				// A sprite was drawn. Data: x | y << 8 | rows << 16 | collision << 24.
+	Fault,				// The emulator stopped. Data: the Chip8Fault.
+	AudioPattern,		// An audio pattern was loaded (F002). Payload: the 16 pattern bytes.
+	AudioPitch,			// The pitch register was set (FX3A). Data: the pitch.
+	ApplicationTooBig,	// The application doesn't fit into memory. Data: its size.
+	ApplicationNotFound,	// The application file couldn't be opened.
+	OutputNotWritable	// An output file couldn't be opened for writing.
+};
+
+struct Chip8Event {
+	Chip8EventType     type;
+	unsigned short     pc;		// Address of the instruction that raised the event.
+	unsigned int       data;	// Payload depending on the type.
+	unsigned long long cycle;	// Emulated cycle the event happened at.
+	unsigned char      payload[16];	// Additional data of AudioPattern events.
+};
+
+// Receives the events of an emulator on the emulation thread
+class Chip8EventSink {
+	public:
+		virtual ~Chip8EventSink() {}
+		virtual void Push(const Chip8Event &event) = 0;	// Must not block.
+};
+
+// Sink that passes events on to several sinks
+class Chip8EventFanout : public Chip8EventSink {
+	public:
+		void Add(Chip8EventSink *sink) { sinks.push_back(sink); }
+
+		void Push(const Chip8Event &event) override
+		{
+			for (size_t i = 0; i < sinks.size(); i++)
+			{
+				sinks[i]->Push(event);
+			}
+		}
+
+	private:
+		std::vector<Chip8EventSink *> sinks;
+};
+
+// Sink that queues events for a consumer on another thread. Events that
+// don't fit into the full queue are dropped and counted.
+class Chip8EventQueue : public Chip8EventSink {
+	public:
+		Chip8EventQueue(size_t capacity = 1024) : queue(capacity), dropped(0) {}
+
+		void Push(const Chip8Event &event) override;
+		bool Pop(Chip8Event &event) { return queue.Pop(event); }	// Consumer side.
+
+		unsigned long long GetDropped() const { return dropped.load(std::memory_order_relaxed); }	// Events lost to a full queue.
+
+	private:
+		Chip8Queue<Chip8Event> queue;
+		std::atomic<unsigned long long> dropped;
+};
+
+// Writes the events of a queue to a stream on a thread of its own
+class Chip8EventLogger {
+	public:
+		Chip8EventLogger(Chip8EventQueue &queue, std::ostream &out);
+		~Chip8EventLogger();
+
+		void Start();		// Start the logging thread.
+		void Stop();		// Log the remaining events and stop the logging thread.
+
+		void ToggleSound() { soundEnabled = !soundEnabled; }	// Toggles the terminal bell off or on.
+		void SetLogDraws(bool logDraws) { this->logDraws = logDraws; }	// Draw events are frequent, so they are skipped by default.
+
+	private:
+		Chip8EventLogger(const Chip8EventLogger &);
+		Chip8EventLogger &operator=(const Chip8EventLogger &);
+
+		Chip8EventQueue   &queue;
+		std::ostream      &out;
+		std::thread       thread;
+		std::atomic<bool> running;
+		std::atomic<bool> soundEnabled;		// Whether or not the logger rings the terminal bell.
+		std::atomic<bool> logDraws;
+
+		void run();
+		void drain();
+		void log(const Chip8Event &event);
+};
+
+#endif
@@ -0,0 +1,320 @@
+/**
+ *	@file	chip8_ir.cpp
+ *	@author	Dejan Azinovic (dazinovic)
+ *	@date	18.10.2026
+ *
+ *	Contains an implementation of all methods from the chip8_ir header.
+ */
+
+#include "chip8_ir.h"
+
+const static unsigned int VF_BIT = 1 << 0xF;
+
+// Runs every pass
+void Chip8IrBlock::Optimize()
+{
+	PropagateConstants();
+	EliminateDeadFlags();
+	RemoveRedundantI();
+}
+
+// Tracks the registers with a known value through the block. A modelled
+// instruction whose inputs are all known becomes a Load of its result.
+void Chip8IrBlock::PropagateConstants()
+{
+	unsigned int known = 0;
+	unsigned char values[16] = {};
+	for (size_t i = 0; i < insts.size(); i++)
+	{
+		Chip8IrInst &inst = insts[i];
+		if (inst.op == Chip8IrOp::Opaque)
+		{
+			known &= ~inst.defs;
+			continue;
+		}
+
+		bool folded = (uses(inst) & ~known) == 0;
+		evaluate(inst, values);
+		if (folded)
+		{
+			// Only the V registers are tracked, so AddI is never folded
+			known |= writes(inst) & ~I_BIT;
+			if (inst.op != Chip8IrOp::Load && inst.op != Chip8IrOp::Nop && inst.op != Chip8IrOp::SetI)
+			{
+				inst.op = Chip8IrOp::Load;
+				inst.imm = values[inst.x];
+				inst.setsFlag = inst.setsFlag && inst.x != 0xF;
+				inst.flag = values[0xF];
+				++changes;
+			}
+		}
+		else
+		{
+			known &= ~writes(inst);
+		}
+	}
+}
+
+// Walks the block backwards with the liveness of VF. A flag that is written
+// while VF is dead is dropped, unless the instruction reads VF itself.
+void Chip8IrBlock::EliminateDeadFlags()
+{
+	bool live = true;
+	for (size_t i = insts.size(); i-- > 0;)
+	{
+		Chip8IrInst &inst = insts[i];
+		if (inst.op == Chip8IrOp::Opaque)
+		{
+			live = true;
+			continue;
+		}
+
+		bool reads = (uses(inst) & VF_BIT) != 0;
+		if (!live && inst.setsFlag && inst.x != 0xF && !reads)
+		{
+			inst.setsFlag = false;
+			++changes;
+		}
+		live = (live && (writes(inst) & VF_BIT) == 0) || reads;
+	}
+}
+
+// Drops ANNN when I already holds NNN
+void Chip8IrBlock::RemoveRedundantI()
+{
+	bool known = false;
+	unsigned short value = 0;
+	for (size_t i = 0; i < insts.size(); i++)
+	{
+		Chip8IrInst &inst = insts[i];
+		if (inst.op == Chip8IrOp::SetI)
+		{
+			if (known && value == inst.imm)
+			{
+				inst.op = Chip8IrOp::Nop;
+				++changes;
+			}
+			known = true;
+			value = inst.imm;
+		}
+		else if (inst.op == Chip8IrOp::AddI || (inst.op == Chip8IrOp::Opaque && (inst.defs & I_BIT) != 0))
+		{
+			known = false;
+		}
+	}
+}
+
+// Decodes a guest instruction
+Chip8IrInst Chip8IrBlock::decode(unsigned short opcode, bool shiftUsesVy, bool shiftFlagFirst, bool logicResetsVf)
+{
+	Chip8IrInst inst;
+	inst.op = Chip8IrOp::Opaque;
+	inst.opcode = opcode;
+	inst.x = (opcode & 0x0F00) >> 8;
+	inst.y = (opcode & 0x00F0) >> 4;
+	inst.imm = 0;
+	inst.setsFlag = false;
+	inst.flag = 0;
+	inst.defs = 0xFFFF | I_BIT;
+
+	unsigned int vx = 1 << inst.x;
+	switch (opcode & 0xF000)
+	{
+	case 0x6000:
+		inst.op = Chip8IrOp::Load;
+		inst.imm = opcode & 0x00FF;
+		break;
+	case 0x7000:
+		inst.op = Chip8IrOp::AddImm;
+		inst.imm = opcode & 0x00FF;
+		break;
+	case 0x8000:
+		switch (opcode & 0x000F)
+		{
+		case 0x0: inst.op = Chip8IrOp::Move; break;
+		case 0x1: inst.op = Chip8IrOp::Or; inst.setsFlag = logicResetsVf; break;
+		case 0x2: inst.op = Chip8IrOp::And; inst.setsFlag = logicResetsVf; break;
+		case 0x3: inst.op = Chip8IrOp::Xor; inst.setsFlag = logicResetsVf; break;
+		case 0x4: inst.op = Chip8IrOp::Add; inst.setsFlag = true; break;
+		case 0x5: inst.op = Chip8IrOp::Sub; inst.setsFlag = true; break;
+		case 0x6: inst.op = Chip8IrOp::ShiftRight; inst.setsFlag = true; break;
+		case 0x7: inst.op = Chip8IrOp::ReverseSub; inst.setsFlag = true; break;
+		case 0xE: inst.op = Chip8IrOp::ShiftLeft; inst.setsFlag = true; break;
+		}
+		if ((inst.op == Chip8IrOp::ShiftRight || inst.op == Chip8IrOp::ShiftLeft) && !shiftUsesVy)
+		{
+			inst.y = inst.x;
+		}
+		if ((inst.op == Chip8IrOp::ShiftRight || inst.op == Chip8IrOp::ShiftLeft) && shiftFlagFirst && inst.x == 0xF)
+		{
+			// 8F06 and 8F0E shift the flag they just wrote, which the model
+			// can't express, so they are left to their handlers
+			inst.op = Chip8IrOp::Opaque;
+			inst.setsFlag = false;
+			inst.defs = vx;
+		}
+		break;
+	case 0xA000:
+		inst.op = Chip8IrOp::SetI;
+		inst.imm = opcode & 0x0FFF;
+		break;
+	case 0xC000:
+		inst.defs = vx;
+		break;
+	case 0xD000:
+		inst.defs = VF_BIT;
+		break;
+	case 0xF000:
+		switch (opcode & 0x00FF)
+		{
+		case 0x07:
+		case 0x0A:
+			inst.defs = vx;
+			break;
+		case 0x15:
+		case 0x18:
+		case 0x33:
+			inst.defs = 0;
+			break;
+		case 0x1E:
+			inst.op = Chip8IrOp::AddI;
+			inst.setsFlag = true;
+			break;
+		case 0x29:
+		case 0x30:
+		case 0x55:
+			inst.defs = I_BIT;
+			break;
+		case 0x65:
+			inst.defs = ((vx << 1) - 1) | I_BIT;
+			break;
+		}
+		break;
+	}
+	return inst;
+}
+
+// Returns the registers a modelled instruction reads
+unsigned int Chip8IrBlock::uses(const Chip8IrInst &inst)
+{
+	switch (inst.op)
+	{
+	case Chip8IrOp::Move:
+	case Chip8IrOp::ShiftRight:
+	case Chip8IrOp::ShiftLeft:
+		return 1 << inst.y;
+	case Chip8IrOp::AddImm:
+		return 1 << inst.x;
+	case Chip8IrOp::Or:
+	case Chip8IrOp::And:
+	case Chip8IrOp::Xor:
+	case Chip8IrOp::Add:
+	case Chip8IrOp::Sub:
+	case Chip8IrOp::ReverseSub:
+		return 1 << inst.x | 1 << inst.y;
+	case Chip8IrOp::AddI:
+		return 1 << inst.x | I_BIT;
+	default:
+		return 0;
+	}
+}
+
+// Returns the registers a modelled instruction writes
+unsigned int Chip8IrBlock::writes(const Chip8IrInst &inst)
+{
+	unsigned int flag = inst.setsFlag ? VF_BIT : 0;
+	switch (inst.op)
+	{
+	case Chip8IrOp::Nop:
+		return 0;
+	case Chip8IrOp::SetI:
+		return I_BIT;
+	case Chip8IrOp::AddI:
+		return I_BIT | flag;
+	default:
+		return 1 << inst.x | flag;
+	}
+}
+
+// Executes a modelled instruction on the registers, in the same order as
+// the handlers of the core
+void Chip8IrBlock::evaluate(const Chip8IrInst &inst, unsigned char *V)
+{
+	unsigned char source;
+	switch (inst.op)
+	{
+	case Chip8IrOp::Load:
+		if (inst.setsFlag)
+		{
+			V[0xF] = inst.flag;
+		}
+		V[inst.x] = (unsigned char)inst.imm;
+		break;
+	case Chip8IrOp::Move:
+		V[inst.x] = V[inst.y];
+		break;
+	case Chip8IrOp::AddImm:
+		V[inst.x] += (unsigned char)inst.imm;
+		break;
+	case Chip8IrOp::Or:
+		V[inst.x] |= V[inst.y];
+		if (inst.setsFlag)
+		{
+			V[0xF] = 0;
+		}
+		break;
+	case Chip8IrOp::And:
+		V[inst.x] &= V[inst.y];
+		if (inst.setsFlag)
+		{
+			V[0xF] = 0;
+		}
+		break;
+	case Chip8IrOp::Xor:
+		V[inst.x] ^= V[inst.y];
+		if (inst.setsFlag)
+		{
+			V[0xF] = 0;
+		}
+		break;
+	case Chip8IrOp::Add:
+		if (inst.setsFlag)
+		{
+			V[0xF] = (V[inst.x] + V[inst.y]) >> 8;
+		}
+		V[inst.x] += V[inst.y];
+		break;
+	case Chip8IrOp::Sub:
+		if (inst.setsFlag)
+		{
+			V[0xF] = (V[inst.x] >= V[inst.y]);
+		}
+		V[inst.x] -= V[inst.y];
+		break;
+	case Chip8IrOp::ReverseSub:
+		if (inst.setsFlag)
+		{
+			V[0xF] = (V[inst.x] <= V[inst.y]);
+		}
+		V[inst.x] = V[inst.y] - V[inst.x];
+		break;
+	case Chip8IrOp::ShiftRight:
+		source = V[inst.y];
+		if (inst.setsFlag)
+		{
+			V[0xF] = source & 0x01;
+		}
+		V[inst.x] = source >> 1;
+		break;
+	case Chip8IrOp::ShiftLeft:
+		source = V[inst.y];
+		if (inst.setsFlag)
+		{
+			V[0xF] = source >> 7;
+		}
+		V[inst.x] = source << 1;
+		break;
+	default:
+		break;
+	}
+}
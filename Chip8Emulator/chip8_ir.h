@@ -0,0 +1,85 @@
+/**
+ *	@file	chip8_ir.h
+ *	@author	Dejan Azinovic (dazinovic)
+ *	@date	18.10.2026
+ *
+ *	Header file for Chip8IrBlock, a small intermediate representation of one
+ *	Chip-8 basic block for the compiled tiers. Every instruction names the
+ *	registers it defines and uses, which is all the passes need:
+ *
+ *		PropagateConstants	Tracks the values loaded by 6XNN through the block and folds
+ *							arithmetic on known registers into loads of the result.
+ *		EliminateDeadFlags	Drops the VF result of 8XY4, 8XY5, 8XY6, 8XY7, 8XYE, FX1E and
+ *							the logic operations where VF is overwritten before it is read.
+ *		RemoveRedundantI	Drops ANNN when I is already known to hold NNN.
+ *
+ *	Every guest instruction stays one IR instruction (possibly a Nop), so a
+ *	block still takes one cycle per instruction. Instructions the IR does not
+ *	model are Opaque: they are executed by their handler and act as a barrier
+ *	that reads every register, so the state is exact wherever the core could
+ *	fault or report an event. VF is assumed to be live at the end of a block.
+ */
+
+#ifndef CHIP8_IR
+#define CHIP8_IR
+
+#include <cstddef>
+#include <vector>
+
+enum class Chip8IrOp : unsigned char {
+	Nop,			// Does nothing (the instruction was redundant).
+	Load,			// VX = imm.
+	Move,			// VX = VY.
+	AddImm,			// VX += imm.
+	Or,				// VX |= VY, VF = 0 with the flag.
+	And,			// VX &= VY, VF = 0 with the flag.
+	Xor,			// VX ^= VY, VF = 0 with the flag.
+	Add,			// VX += VY, VF = carry.
+	Sub,			// VX -= VY, VF = no borrow.
+	ReverseSub,		// VX = VY - VX, VF = no borrow.
+	ShiftRight,		// VX = VY >> 1, VF = shifted out bit (Y is X unless the quirks shift VY).
+	ShiftLeft,		// VX = VY << 1, VF = shifted out bit.
+	SetI,			// I = imm.
+	AddI,			// I += VX, VF = carry out of 16 bits.
+	Opaque			// Anything else, executed by its handler.
+};
+
+struct Chip8IrInst {
+	Chip8IrOp      op;
+	unsigned short opcode;		// Guest instruction.
+	unsigned char  x;
+	unsigned char  y;
+	unsigned short imm;
+	bool           setsFlag;	// Whether VF is written as well.
+	unsigned char  flag;		// Value written to VF by a folded Load.
+	unsigned int   defs;		// Registers an Opaque instruction may write (bit i for Vi, I_BIT for I).
+};
+
+class Chip8IrBlock {
+	public:
+		Chip8IrBlock() : changes(0) {}
+
+		const static unsigned int I_BIT = 1 << 16;
+
+		template <class Quirks>
+		void Append(unsigned short opcode) { insts.push_back(decode(opcode, Quirks::SHIFT_USES_VY, Quirks::SHIFT_FLAG_FIRST, Quirks::LOGIC_RESETS_VF)); }	// Appends a guest instruction, decoded for the quirk profile.
+		void Optimize();				// Runs every pass.
+		void PropagateConstants();
+		void EliminateDeadFlags();
+		void RemoveRedundantI();
+
+		size_t GetSize() const { return insts.size(); }
+		const Chip8IrInst &operator[](size_t i) const { return insts[i]; }
+		unsigned int GetChangeCount() const { return changes; }	// Number of instructions the passes changed.
+
+	private:
+		std::vector<Chip8IrInst> insts;
+		unsigned int             changes;
+
+		static Chip8IrInst decode(unsigned short opcode, bool shiftUsesVy, bool shiftFlagFirst, bool logicResetsVf);
+		static unsigned int uses(const Chip8IrInst &inst);			// Registers a modelled instruction reads.
+		static unsigned int writes(const Chip8IrInst &inst);		// Registers a modelled instruction writes.
+		static void evaluate(const Chip8IrInst &inst, unsigned char *V);	// Executes a modelled instruction on the registers.
+};
+
+#endif
@@ -0,0 +1,944 @@
+/**
+ *	@file	chip8_lockstep.cpp
+ *	@author	Dejan Azinovic (dazinovic)
+ *	@date	18.10.2026
+ *
+ *	Contains an implementation of all methods from the chip8_lockstep header.
+ *	Every instruction does what the same instruction does in Chip8 in the
+ *	64x32 mode, in the same order, and faults where Chip8 faults. On top of
+ *	that, 00FF faults, and the sound timer never beeps (the engine is meant
+ *	for headless workloads). Chip8Fuzz/chip8_lockstep_fuzz.cpp checks every
+ *	lane against a Chip8.
+ */
+
+#include "chip8_lockstep.h"
+#include "chip8.h"
+#include "chip8_cpu.h"
+#include <cstring>
+#include <cstdlib>
+#include <fstream>
+
+#if defined(CHIP8_SIMD_X86)
+#include <immintrin.h>
+#endif
+
+// The kernel templates pass AVX vectors around without being compiled for
+// AVX themselves, which GCC warns about. They are only ever inlined into
+// functions that are.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+
+// Lane types. Every type provides the handful of byte-wise operations the
+// ALU kernels need, so each kernel is written once and instantiated for
+// every instruction set. Chip8Cpu picks one of them when an engine is
+// created.
+struct ScalarLanes
+{
+	typedef unsigned char Vec;
+	const static unsigned int LANES = 1;
+
+	static Vec load(const unsigned char *p) { return *p; }
+	static void store(unsigned char *p, Vec v) { *p = v; }
+	static Vec set(unsigned char n) { return n; }
+	static Vec add(Vec a, Vec b) { return a + b; }
+	static Vec sub(Vec a, Vec b) { return a - b; }
+	static Vec bitOr(Vec a, Vec b) { return a | b; }
+	static Vec bitAnd(Vec a, Vec b) { return a & b; }
+	static Vec bitXor(Vec a, Vec b) { return a ^ b; }
+	static Vec carry(Vec a, Vec b) { return (a + b) >> 8; }		// 1 if a + b overflows.
+	static Vec greaterEqual(Vec a, Vec b) { return a >= b; }	// 1 if a >= b.
+	static Vec lsb(Vec a) { return a & 0x01; }
+	static Vec msb(Vec a) { return a >> 7; }
+	static Vec shiftRight(Vec a) { return a >> 1; }
+	static Vec shiftLeft(Vec a) { return a << 1; }
+	static Vec decrement(Vec a) { return a > 0 ? a - 1 : 0; }	// Saturating decrement.
+};
+
+#if defined(CHIP8_SIMD_X86)
+struct Sse2Lanes
+{
+	typedef __m128i Vec;
+	const static unsigned int LANES = 16;
+
+	static Vec load(const unsigned char *p) { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)); }
+	static void store(unsigned char *p, Vec v) { _mm_storeu_si128(reinterpret_cast<__m128i *>(p), v); }
+	static Vec set(unsigned char n) { return _mm_set1_epi8(static_cast<char>(n)); }
+	static Vec add(Vec a, Vec b) { return _mm_add_epi8(a, b); }
+	static Vec sub(Vec a, Vec b) { return _mm_sub_epi8(a, b); }
+	static Vec bitOr(Vec a, Vec b) { return _mm_or_si128(a, b); }
+	static Vec bitAnd(Vec a, Vec b) { return _mm_and_si128(a, b); }
+	static Vec bitXor(Vec a, Vec b) { return _mm_xor_si128(a, b); }
+	static Vec carry(Vec a, Vec b) { return _mm_andnot_si128(_mm_cmpeq_epi8(_mm_adds_epu8(a, b), _mm_add_epi8(a, b)), set(1)); }
+	static Vec greaterEqual(Vec a, Vec b) { return _mm_and_si128(_mm_cmpeq_epi8(_mm_max_epu8(a, b), a), set(1)); }
+	static Vec lsb(Vec a) { return _mm_and_si128(a, set(0x01)); }
+	static Vec msb(Vec a) { return _mm_and_si128(_mm_srli_epi16(a, 7), set(0x01)); }
+	static Vec shiftRight(Vec a) { return _mm_and_si128(_mm_srli_epi16(a, 1), set(0x7F)); }
+	static Vec shiftLeft(Vec a) { return _mm_add_epi8(a, a); }
+	static Vec decrement(Vec a) { return _mm_subs_epu8(a, set(1)); }
+};
+
+struct Avx2Lanes
+{
+	typedef __m256i Vec;
+	const static unsigned int LANES = 32;
+
+	CHIP8_TARGET_AVX2 static Vec load(const unsigned char *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+	CHIP8_TARGET_AVX2 static void store(unsigned char *p, Vec v) { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v); }
+	CHIP8_TARGET_AVX2 static Vec set(unsigned char n) { return _mm256_set1_epi8(static_cast<char>(n)); }
+	CHIP8_TARGET_AVX2 static Vec add(Vec a, Vec b) { return _mm256_add_epi8(a, b); }
+	CHIP8_TARGET_AVX2 static Vec sub(Vec a, Vec b) { return _mm256_sub_epi8(a, b); }
+	CHIP8_TARGET_AVX2 static Vec bitOr(Vec a, Vec b) { return _mm256_or_si256(a, b); }
+	CHIP8_TARGET_AVX2 static Vec bitAnd(Vec a, Vec b) { return _mm256_and_si256(a, b); }
+	CHIP8_TARGET_AVX2 static Vec bitXor(Vec a, Vec b) { return _mm256_xor_si256(a, b); }
+	CHIP8_TARGET_AVX2 static Vec carry(Vec a, Vec b) { return _mm256_andnot_si256(_mm256_cmpeq_epi8(_mm256_adds_epu8(a, b), _mm256_add_epi8(a, b)), set(1)); }
+	CHIP8_TARGET_AVX2 static Vec greaterEqual(Vec a, Vec b) { return _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_max_epu8(a, b), a), set(1)); }
+	CHIP8_TARGET_AVX2 static Vec lsb(Vec a) { return _mm256_and_si256(a, set(0x01)); }
+	CHIP8_TARGET_AVX2 static Vec msb(Vec a) { return _mm256_and_si256(_mm256_srli_epi16(a, 7), set(0x01)); }
+	CHIP8_TARGET_AVX2 static Vec shiftRight(Vec a) { return _mm256_and_si256(_mm256_srli_epi16(a, 1), set(0x7F)); }
+	CHIP8_TARGET_AVX2 static Vec shiftLeft(Vec a) { return _mm256_add_epi8(a, a); }
+	CHIP8_TARGET_AVX2 static Vec decrement(Vec a) { return _mm256_subs_epu8(a, set(1)); }
+};
+
+#if defined(CHIP8_SIMD_AVX512)
+struct Avx512Lanes
+{
+	typedef __m512i Vec;
+	const static unsigned int LANES = 64;
+
+	CHIP8_TARGET_AVX512 static Vec load(const unsigned char *p) { return _mm512_loadu_si512(p); }
+	CHIP8_TARGET_AVX512 static void store(unsigned char *p, Vec v) { _mm512_storeu_si512(p, v); }
+	CHIP8_TARGET_AVX512 static Vec set(unsigned char n) { return _mm512_set1_epi8(static_cast<char>(n)); }
+	CHIP8_TARGET_AVX512 static Vec add(Vec a, Vec b) { return _mm512_add_epi8(a, b); }
+	CHIP8_TARGET_AVX512 static Vec sub(Vec a, Vec b) { return _mm512_sub_epi8(a, b); }
+	CHIP8_TARGET_AVX512 static Vec bitOr(Vec a, Vec b) { return _mm512_or_si512(a, b); }
+	CHIP8_TARGET_AVX512 static Vec bitAnd(Vec a, Vec b) { return _mm512_and_si512(a, b); }
+	CHIP8_TARGET_AVX512 static Vec bitXor(Vec a, Vec b) { return _mm512_xor_si512(a, b); }
+	CHIP8_TARGET_AVX512 static Vec carry(Vec a, Vec b) { return _mm512_maskz_mov_epi8(_mm512_cmplt_epu8_mask(_mm512_add_epi8(a, b), a), set(1)); }
+	CHIP8_TARGET_AVX512 static Vec greaterEqual(Vec a, Vec b) { return _mm512_maskz_mov_epi8(_mm512_cmpge_epu8_mask(a, b), set(1)); }
+	CHIP8_TARGET_AVX512 static Vec lsb(Vec a) { return _mm512_and_si512(a, set(0x01)); }
+	CHIP8_TARGET_AVX512 static Vec msb(Vec a) { return _mm512_and_si512(_mm512_srli_epi16(a, 7), set(0x01)); }
+	CHIP8_TARGET_AVX512 static Vec shiftRight(Vec a) { return _mm512_and_si512(_mm512_srli_epi16(a, 1), set(0x7F)); }
+	CHIP8_TARGET_AVX512 static Vec shiftLeft(Vec a) { return _mm512_add_epi8(a, a); }
+	CHIP8_TARGET_AVX512 static Vec decrement(Vec a) { return _mm512_subs_epu8(a, set(1)); }
+};
+#endif
+#endif
+
+// ALU kernels. VX, VY and VF may alias, so every kernel loads and stores in
+// the same order as the corresponding Chip8 opcode function does.
+
+// 7XNN
+template <class L>
+CHIP8_FORCE_INLINE static void laneAddN(unsigned char *vx, unsigned char n, unsigned int count)
+{
+	for (unsigned int i = 0; i < count; i += L::LANES)
+	{
+		L::store(vx + i, L::add(L::load(vx + i), L::set(n)));
+	}
+}
+
+// 8XY1
+template <class L>
+CHIP8_FORCE_INLINE static void laneOr(unsigned char *vx, const unsigned char *vy, unsigned int count)
+{
+	for (unsigned int i = 0; i < count; i += L::LANES)
+	{
+		L::store(vx + i, L::bitOr(L::load(vx + i), L::load(vy + i)));
+	}
+}
+
+// 8XY2
+template <class L>
+CHIP8_FORCE_INLINE static void laneAnd(unsigned char *vx, const unsigned char *vy, unsigned int count)
+{
+	for (unsigned int i = 0; i < count; i += L::LANES)
+	{
+		L::store(vx + i, L::bitAnd(L::load(vx + i), L::load(vy + i)));
+	}
+}
+
+// 8XY3
+template <class L>
+CHIP8_FORCE_INLINE static void laneXor(unsigned char *vx, const unsigned char *vy, unsigned int count)
+{
+	for (unsigned int i = 0; i < count; i += L::LANES)
+	{
+		L::store(vx + i, L::bitXor(L::load(vx + i), L::load(vy + i)));
+	}
+}
+
+// 8XY4
+template <class L>
+CHIP8_FORCE_INLINE static void laneAdd(unsigned char *vx, const unsigned char *vy, unsigned char *vf, unsigned int count)
+{
+	for (unsigned int i = 0; i < count; i += L::LANES)
+	{
+		L::store(vf + i, L::carry(L::load(vx + i), L::load(vy + i)));
+		L::store(vx + i, L::add(L::load(vx + i), L::load(vy + i)));
+	}
+}
+
+// 8XY5
+template <class L>
+CHIP8_FORCE_INLINE static void laneSubtract(unsigned char *vx, const unsigned char *vy, unsigned char *vf, unsigned int count)
+{
+	for (unsigned int i = 0; i < count; i += L::LANES)
+	{
+		L::store(vf + i, L::greaterEqual(L::load(vx + i), L::load(vy + i)));
+		L::store(vx + i, L::sub(L::load(vx + i), L::load(vy + i)));
+	}
+}
+
+// 8XY6
+template <class L>
+CHIP8_FORCE_INLINE static void laneShiftRight(unsigned char *vx, unsigned char *vf, unsigned int count)
+{
+	for (unsigned int i = 0; i < count; i += L::LANES)
+	{
+		L::store(vf + i, L::lsb(L::load(vx + i)));
+		L::store(vx + i, L::shiftRight(L::load(vx + i)));
+	}
+}
+
+// 8XY7
+template <class L>
+CHIP8_FORCE_INLINE static void laneReverseSubtract(unsigned char *vx, const unsigned char *vy, unsigned char *vf, unsigned int count)
+{
+	for (unsigned int i = 0; i < count; i += L::LANES)
+	{
+		L::store(vf + i, L::greaterEqual(L::load(vy + i), L::load(vx + i)));
+		L::store(vx + i, L::sub(L::load(vy + i), L::load(vx + i)));
+	}
+}
+
+// 8XYE
+template <class L>
+CHIP8_FORCE_INLINE static void laneShiftLeft(unsigned char *vx, unsigned char *vf, unsigned int count)
+{
+	for (unsigned int i = 0; i < count; i += L::LANES)
+	{
+		L::store(vf + i, L::msb(L::load(vx + i)));
+		L::store(vx + i, L::shiftLeft(L::load(vx + i)));
+	}
+}
+
+// DXYN. Flips the given pixels of every lane's screen, which is stored
+// [pixel * count + lane], and sets VF of every lane if a pixel was set.
+template <class L>
+CHIP8_FORCE_INLINE static void laneDraw(unsigned char *screen, const unsigned short *pixels, unsigned int pixelCount, unsigned char *vf, unsigned int count)
+{
+	for (unsigned int i = 0; i < count; i += L::LANES)
+	{
+		typename L::Vec collision = L::set(0);
+		for (unsigned int p = 0; p < pixelCount; p++)
+		{
+			unsigned char *lanes = screen + pixels[p] * count + i;
+			typename L::Vec current = L::load(lanes);
+			collision = L::bitOr(collision, current);
+			L::store(lanes, L::bitXor(current, L::set(1)));
+		}
+		L::store(vf + i, collision);
+	}
+}
+
+// Timers
+template <class L>
+CHIP8_FORCE_INLINE static void laneDecrement(unsigned char *timers, unsigned int count)
+{
+	for (unsigned int i = 0; i < count; i += L::LANES)
+	{
+		L::store(timers + i, L::decrement(L::load(timers + i)));
+	}
+}
+
+// 7XNN and 8XY1 to 8XYE
+template <class L>
+CHIP8_FORCE_INLINE static void laneAlu(unsigned short opcode, unsigned char *vx, const unsigned char *vy, unsigned char *vf, unsigned int count)
+{
+	if ((opcode & 0xF000) == 0x7000)
+	{
+		laneAddN<L>(vx, opcode & 0x00FF, count);
+		return;
+	}
+
+	switch (opcode & 0x000F)
+	{
+	case 0x1: laneOr<L>(vx, vy, count);					break;
+	case 0x2: laneAnd<L>(vx, vy, count);				break;
+	case 0x3: laneXor<L>(vx, vy, count);				break;
+	case 0x4: laneAdd<L>(vx, vy, vf, count);			break;
+	case 0x5: laneSubtract<L>(vx, vy, vf, count);		break;
+	case 0x6: laneShiftRight<L>(vx, vf, count);			break;
+	case 0x7: laneReverseSubtract<L>(vx, vy, vf, count);	break;
+	case 0xE: laneShiftLeft<L>(vx, vf, count);			break;
+	}
+}
+
+// Kernels bound to one lane type
+struct Chip8LaneKernels {
+	Chip8Simd simd;
+	void (*alu)(unsigned short opcode, unsigned char *vx, const unsigned char *vy, unsigned char *vf, unsigned int count);
+	void (*decrement)(unsigned char *timers, unsigned int count);
+	void (*draw)(unsigned char *screen, const unsigned short *pixels, unsigned int pixelCount, unsigned char *vf, unsigned int count);
+};
+
+// Entry points for each lane type. The AVX2 and AVX-512 ones are compiled
+// for their instruction set, which lets the kernels inline into them.
+static void scalarAlu(unsigned short opcode, unsigned char *vx, const unsigned char *vy, unsigned char *vf, unsigned int count) { laneAlu<ScalarLanes>(opcode, vx, vy, vf, count); }
+static void scalarDecrement(unsigned char *timers, unsigned int count) { laneDecrement<ScalarLanes>(timers, count); }
+static void scalarDraw(unsigned char *screen, const unsigned short *pixels, unsigned int pixelCount, unsigned char *vf, unsigned int count) { laneDraw<ScalarLanes>(screen, pixels, pixelCount, vf, count); }
+
+#if defined(CHIP8_SIMD_X86)
+static void sse2Alu(unsigned short opcode, unsigned char *vx, const unsigned char *vy, unsigned char *vf, unsigned int count) { laneAlu<Sse2Lanes>(opcode, vx, vy, vf, count); }
+static void sse2Decrement(unsigned char *timers, unsigned int count) { laneDecrement<Sse2Lanes>(timers, count); }
+static void sse2Draw(unsigned char *screen, const unsigned short *pixels, unsigned int pixelCount, unsigned char *vf, unsigned int count) { laneDraw<Sse2Lanes>(screen, pixels, pixelCount, vf, count); }
+CHIP8_TARGET_AVX2 static void avx2Alu(unsigned short opcode, unsigned char *vx, const unsigned char *vy, unsigned char *vf, unsigned int count) { laneAlu<Avx2Lanes>(opcode, vx, vy, vf, count); }
+CHIP8_TARGET_AVX2 static void avx2Decrement(unsigned char *timers, unsigned int count) { laneDecrement<Avx2Lanes>(timers, count); }
+CHIP8_TARGET_AVX2 static void avx2Draw(unsigned char *screen, const unsigned short *pixels, unsigned int pixelCount, unsigned char *vf, unsigned int count) { laneDraw<Avx2Lanes>(screen, pixels, pixelCount, vf, count); }
+#if defined(CHIP8_SIMD_AVX512)
+CHIP8_TARGET_AVX512 static void avx512Alu(unsigned short opcode, unsigned char *vx, const unsigned char *vy, unsigned char *vf, unsigned int count) { laneAlu<Avx512Lanes>(opcode, vx, vy, vf, count); }
+CHIP8_TARGET_AVX512 static void avx512Decrement(unsigned char *timers, unsigned int count) { laneDecrement<Avx512Lanes>(timers, count); }
+CHIP8_TARGET_AVX512 static void avx512Draw(unsigned char *screen, const unsigned short *pixels, unsigned int pixelCount, unsigned char *vf, unsigned int count) { laneDraw<Avx512Lanes>(screen, pixels, pixelCount, vf, count); }
+#endif
+#endif
+
+// Picks the kernels for the instruction set selected by Chip8Cpu
+static const Chip8LaneKernels *selectLaneKernels()
+{
+	static const Chip8LaneKernels scalar = { Chip8Simd::Scalar, scalarAlu, scalarDecrement, scalarDraw };
+#if defined(CHIP8_SIMD_X86)
+	static const Chip8LaneKernels sse2 = { Chip8Simd::Sse2, sse2Alu, sse2Decrement, sse2Draw };
+	static const Chip8LaneKernels avx2 = { Chip8Simd::Avx2, avx2Alu, avx2Decrement, avx2Draw };
+#if defined(CHIP8_SIMD_AVX512)
+	static const Chip8LaneKernels avx512 = { Chip8Simd::Avx512, avx512Alu, avx512Decrement, avx512Draw };
+#endif
+	switch (Chip8Cpu::GetSimd())
+	{
+	case Chip8Simd::Scalar:	return &scalar;
+	case Chip8Simd::Sse2:	return &sse2;
+	case Chip8Simd::Avx2:	return &avx2;
+#if defined(CHIP8_SIMD_AVX512)
+	case Chip8Simd::Avx512:	return &avx512;
+#endif
+	default:				return &avx2;
+	}
+#else
+	return &scalar;
+#endif
+}
+
+// Lists the pixels a DXYN sprite at (x, y) flips, as y * SCREEN_WIDTH + x,
+// and returns their number. DXY0 draws a 16x16 sprite from 32 bytes, two
+// bytes per row. The sprite wraps around the edges of the screen, so no
+// pixel is listed twice.
+static unsigned int spritePixels(const unsigned char *memory, unsigned short address, unsigned char x, unsigned char y, unsigned char N, unsigned short *pixels)
+{
+	const unsigned int width = Chip8Lockstep::SCREEN_WIDTH;
+	const unsigned int height = Chip8Lockstep::SCREEN_HEIGHT;
+	unsigned int rows = (N == 0) ? 16 : N;
+	unsigned int bytes = (N == 0) ? 2 : 1;	// Sprite bytes per row.
+
+	unsigned int count = 0;
+	for (unsigned int i = 0; i < rows; i++)
+	{
+		unsigned int top = width * ((y + i) & (height - 1));
+		for (unsigned int k = 0; k < bytes; k++)
+		{
+			unsigned char spriteRow = memory[(address + i * bytes + k) & 0x0FFF];
+			for (unsigned int j = 0; j < 8; j++)
+			{
+				if ((spriteRow & (0x80 >> j)) != 0)
+				{
+					pixels[count++] = (unsigned short)(top + ((x + 8 * k + j) & (width - 1)));
+				}
+			}
+		}
+	}
+	return count;
+}
+
+// Whether the first count values are equal
+template <class T>
+static bool uniform(const T *values, unsigned int count)
+{
+	for (unsigned int i = 1; i < count; i++)
+	{
+		if (values[i] != values[0])
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// Whether the lanes of an opcode that was executed lane by lane may end up
+// with different program counters.
+static bool mayDiverge(unsigned short opcode)
+{
+	switch (opcode & 0xF000)
+	{
+	case 0x0000:
+		return opcode != 0x00E0;
+	case 0x3000: case 0x4000: case 0x5000: case 0x9000: case 0xB000: case 0xE000:
+		return true;
+	case 0xF000:
+		return (opcode & 0x00FF) == 0x000A;
+	default:
+		return false;
+	}
+}
+
+Chip8Lockstep::Chip8Lockstep(unsigned int instanceCount) : instanceCount(instanceCount), kernels(selectLaneKernels()), events(nullptr)
+{
+	stride = (instanceCount + LANE_GROUP - 1) / LANE_GROUP * LANE_GROUP;
+	init();
+}
+
+Chip8Lockstep::~Chip8Lockstep()
+{
+}
+
+// Returns the instruction set the ALU kernels run with
+Chip8Simd Chip8Lockstep::GetSimd() const
+{
+	return kernels->simd;
+}
+
+// Initializes all instances
+void Chip8Lockstep::init()
+{
+	V.assign(16 * stride, 0);
+	I.assign(stride, 0);
+	pc.assign(stride, 0x200);
+	sp.assign(stride, 0);
+	stack.assign(16 * stride, 0);
+	delay_timer.assign(stride, 0);
+	sound_timer.assign(stride, 0);
+
+	memory.assign(instanceCount * 4096, 0);
+	screen.assign(SCREEN_WIDTH * SCREEN_HEIGHT * stride, 0);
+	keys.assign(instanceCount * 16, 0);
+	flags.assign(instanceCount * 16, 0);
+	faults.assign(instanceCount, Chip8Fault::None);
+	faultPcs.assign(instanceCount, 0);
+
+	// Load the fontsets
+	for (unsigned int lane = 0; lane < instanceCount; lane++)
+	{
+		memcpy(&memory[lane * 4096], Chip8::fontset, 80);
+		memcpy(&memory[lane * 4096 + 80], Chip8::bigFontset, 160);
+	}
+
+	pcUniform = true;
+	memoryUniform = true;
+	faultCount = 0;
+	leader = 0;
+	lockstepCycles = 0;
+	divergentCycles = 0;
+}
+
+// Copies the screen of one instance, one byte per pixel and row by row
+void Chip8Lockstep::CopyScreen(unsigned int instance, unsigned char *pixels) const
+{
+	for (unsigned int i = 0; i < SCREEN_WIDTH * SCREEN_HEIGHT; i++)
+	{
+		pixels[i] = screen[i * stride + instance];
+	}
+}
+
+// Loads a Chip-8 application into the memory of every instance starting from address 0x200
+bool Chip8Lockstep::LoadApplication(const char *filename)
+{
+	std::ifstream in(filename, std::ios::in | std::ios::binary);
+	if (in.good())
+	{
+		in.seekg(0, std::ios::end);
+		int length = int(in.tellg());
+		if (length >= 0)
+		{
+			std::vector<unsigned char> application(length);
+			in.seekg(0, std::ios::beg);
+			in.read(reinterpret_cast<char *>(application.data()), length);
+			in.close();
+
+			return LoadApplication(application.data(), length);
+		}
+	}
+
+	raise(Chip8EventType::ApplicationNotFound, 0);
+	return false;
+}
+
+// Loads a Chip-8 application from a buffer into the memory of every instance
+bool Chip8Lockstep::LoadApplication(const unsigned char *application, size_t length)
+{
+	if (length > 4096 - 512)
+	{
+		raise(Chip8EventType::ApplicationTooBig, (unsigned int)length);
+		return false;
+	}
+
+	for (unsigned int lane = 0; lane < instanceCount; lane++)
+	{
+		memcpy(&memory[lane * 4096 + 512], application, length);
+	}
+	return true;
+}
+
+// Reports an event to the sink, if any
+void Chip8Lockstep::raise(Chip8EventType type, unsigned int data)
+{
+	if (events != nullptr)
+	{
+		Chip8Event event = { type, 0x200, data, lockstepCycles + divergentCycles, {} };
+		events->Push(event);
+	}
+}
+
+// Fetches the opcode all running lanes are about to execute. Returns false
+// if the lanes disagree on the program counter or on the instruction stored
+// there, or if no lane is running.
+bool Chip8Lockstep::fetchUniform(unsigned short &opcode) const
+{
+	if (!pcUniform || faultCount == instanceCount)
+	{
+		return false;
+	}
+
+	unsigned short address = pc[leader];
+	const unsigned char *leaderMemory = &memory[leader * 4096];
+	opcode = leaderMemory[address & 0x0FFF] << 8 | leaderMemory[(address + 1) & 0x0FFF];
+	if (memoryUniform)
+	{
+		return true;
+	}
+
+	for (unsigned int lane = leader + 1; lane < instanceCount; lane++)
+	{
+		const unsigned char *laneMemory = &memory[lane * 4096];
+		if (faults[lane] == Chip8Fault::None && (laneMemory[address & 0x0FFF] << 8 | laneMemory[(address + 1) & 0x0FFF]) != opcode)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// Executes an opcode across all lanes at once. Returns false for opcodes
+// that have no vector implementation and must be executed lane by lane.
+bool Chip8Lockstep::executeVector(unsigned short opcode)
+{
+	unsigned char *vx = row((opcode & 0x0F00) >> 8);
+	unsigned char *vy = row((opcode & 0x00F0) >> 4);
+	unsigned char *vf = row(0xF);
+
+	switch (opcode & 0xF000)
+	{
+	case 0x0000:
+		// Stopped lanes keep their screen
+		if (opcode != 0x00E0 || faultCount != 0)
+		{
+			return false;
+		}
+		screen.assign(screen.size(), 0);
+		return true;
+	case 0x1000:
+		pc.assign(stride, (opcode & 0x0FFF) - 2);
+		return true;
+	case 0x6000:
+		memset(vx, opcode & 0x00FF, stride);
+		return true;
+	case 0x7000:
+		kernels->alu(opcode, vx, vy, vf, stride);
+		return true;
+	case 0x8000:
+		switch (opcode & 0x000F)
+		{
+		case 0x0: if (vx != vy) memcpy(vx, vy, stride);	return true;
+		case 0x1: case 0x2: case 0x3: case 0x4: case 0x5: case 0x6: case 0x7: case 0xE:
+			kernels->alu(opcode, vx, vy, vf, stride);
+			return true;
+		default:  return false;
+		}
+	case 0xA000:
+		I.assign(stride, opcode & 0x0FFF);
+		return true;
+	case 0xD000:
+		return drawUniform(opcode);
+	case 0xF000:
+		switch (opcode & 0x00FF)
+		{
+		case 0x07: memcpy(vx, delay_timer.data(), stride);	return true;
+		case 0x15: memcpy(delay_timer.data(), vx, stride);	return true;
+		case 0x18: memcpy(sound_timer.data(), vx, stride);	return true;
+		default:   return false;
+		}
+	default:
+		return false;
+	}
+}
+
+// Executes an opcode for a single lane. Mirrors the Chip8 opcode functions,
+// and stops the lane where they fault.
+void Chip8Lockstep::executeLane(unsigned int lane, unsigned short opcode)
+{
+	unsigned char *v = &V[lane];
+	unsigned char *laneMemory = &memory[lane * 4096];
+	unsigned char *laneKeys = &keys[lane * 16];
+	unsigned char *laneFlags = &flags[lane * 16];
+	unsigned char &vx = v[((opcode & 0x0F00) >> 8) * stride];
+	unsigned char &vy = v[((opcode & 0x00F0) >> 4) * stride];
+	unsigned char &vf = v[0xF * stride];
+	unsigned short nnn = opcode & 0x0FFF;
+	unsigned char nn = opcode & 0x00FF;
+
+	switch (opcode & 0xF000)
+	{
+	case 0x0000:
+		if ((opcode & 0xFFF0) == 0x00C0 || opcode == 0x00FB || opcode == 0x00FC)
+		{
+			scroll(lane, opcode);
+		}
+		else if (opcode == 0x00E0 || opcode == 0x00FE)
+		{
+			for (unsigned int i = 0; i < SCREEN_WIDTH * SCREEN_HEIGHT; i++)
+			{
+				screen[i * stride + lane] = 0;
+			}
+		}
+		else if (opcode == 0x00EE)
+		{
+			sp[lane] = (sp[lane] - 1) & 0x000F;
+			pc[lane] = stack[sp[lane] * stride + lane];
+		}
+		else
+		{
+			// 00FF included, there is no 128x64 screen
+			stop(lane, Chip8Fault::IllegalOpcode);
+		}
+		break;
+	case 0x1000:
+		pc[lane] = nnn - 2;
+		break;
+	case 0x2000:
+		stack[sp[lane] * stride + lane] = pc[lane];
+		sp[lane] = (sp[lane] + 1) & 0x000F;
+		pc[lane] = nnn - 2;
+		break;
+	case 0x3000:
+		if (vx == nn) pc[lane] += 2;
+		break;
+	case 0x4000:
+		if (vx != nn) pc[lane] += 2;
+		break;
+	case 0x5000:
+		if ((opcode & 0x000F) != 0) stop(lane, Chip8Fault::IllegalOpcode);
+		else if (vx == vy) pc[lane] += 2;
+		break;
+	case 0x6000:
+		vx = nn;
+		break;
+	case 0x7000:
+		vx += nn;
+		break;
+	case 0x8000:
+		switch (opcode & 0x000F)
+		{
+		case 0x0: vx = vy;	break;
+		case 0x1: vx |= vy;	break;
+		case 0x2: vx &= vy;	break;
+		case 0x3: vx ^= vy;	break;
+		case 0x4: vf = (vx + vy) >> 8;	vx += vy;		break;
+		case 0x5: vf = (vx >= vy);		vx -= vy;		break;
+		case 0x6: vf = vx & 0x01;		vx >>= 1;		break;
+		case 0x7: vf = (vx <= vy);		vx = vy - vx;	break;
+		case 0xE: vf = vx >> 7;			vx <<= 1;		break;
+		default:  stop(lane, Chip8Fault::IllegalOpcode);	break;
+		}
+		break;
+	case 0x9000:
+		if ((opcode & 0x000F) != 0) stop(lane, Chip8Fault::IllegalOpcode);
+		else if (vx != vy) pc[lane] += 2;
+		break;
+	case 0xA000:
+		I[lane] = nnn;
+		break;
+	case 0xB000:
+		pc[lane] = nnn + v[0] - 2;
+		break;
+	case 0xC000:
+		vx = rand() & nn;
+		break;
+	case 0xD000:
+		drawSprite(lane, opcode);
+		break;
+	case 0xE000:
+		if (nn != 0x9E && nn != 0xA1)
+		{
+			stop(lane, Chip8Fault::IllegalOpcode);
+		}
+		else if ((opcode & 0x0001) == 0 ? laneKeys[vx & 0x0F] == 1 : laneKeys[vx & 0x0F] == 0)
+		{
+			pc[lane] += 2;
+		}
+		break;
+	case 0xF000:
+		switch (nn)
+		{
+		case 0x07:
+			vx = delay_timer[lane];
+			break;
+		case 0x0A:
+			{
+				bool keyPressed = false;
+				for (int i = 0; i < 16; i++)
+				{
+					if (laneKeys[i] != 0)
+					{
+						keyPressed = true;
+						vx = i;
+						break;
+					}
+				}
+				if (!keyPressed)
+				{
+					pc[lane] -= 2;
+				}
+			}
+			break;
+		case 0x15:
+			delay_timer[lane] = vx;
+			break;
+		case 0x18:
+			sound_timer[lane] = vx;
+			break;
+		case 0x1E:
+			vf = (I[lane] + vx) >> 16;
+			I[lane] += vx;
+			break;
+		case 0x29:
+			I[lane] = (vx & 0x0F) * 5;
+			break;
+		case 0x30:
+			I[lane] = 80 + (vx & 0x0F) * 10;
+			break;
+		case 0x33:
+			laneMemory[I[lane] & 0x0FFF]       = vx / 100;
+			laneMemory[(I[lane] + 1) & 0x0FFF] = (vx % 100) / 10;
+			laneMemory[(I[lane] + 2) & 0x0FFF] = vx % 10;
+			memoryUniform = false;
+			break;
+		case 0x55:
+			for (int i = 0; i <= (opcode & 0x0F00) >> 8; i++)
+			{
+				laneMemory[(I[lane] + i) & 0x0FFF] = v[i * stride];
+			}
+			memoryUniform = false;
+			break;
+		case 0x65:
+			for (int i = 0; i <= (opcode & 0x0F00) >> 8; i++)
+			{
+				v[i * stride] = laneMemory[(I[lane] + i) & 0x0FFF];
+			}
+			break;
+		case 0x75:
+			for (int i = 0; i <= (opcode & 0x0F00) >> 8; i++)
+			{
+				laneFlags[i] = v[i * stride];
+			}
+			break;
+		case 0x85:
+			for (int i = 0; i <= (opcode & 0x0F00) >> 8; i++)
+			{
+				v[i * stride] = laneFlags[i];
+			}
+			break;
+		default:
+			stop(lane, Chip8Fault::IllegalOpcode);
+			break;
+		}
+		break;
+	}
+}
+
+// DXYN across all lanes at once. Only possible while no lane has stopped
+// and every lane draws the same sprite to the same position, as happens
+// when the lanes run the same drawing code on the same data. Returns false
+// otherwise, and the lanes draw one by one.
+bool Chip8Lockstep::drawUniform(unsigned short opcode)
+{
+	const unsigned char *vx = row((opcode & 0x0F00) >> 8);
+	const unsigned char *vy = row((opcode & 0x00F0) >> 4);
+	if (faultCount != 0 || !uniform(vx, instanceCount) || !uniform(vy, instanceCount) || !uniform(I.data(), instanceCount))
+	{
+		return false;
+	}
+
+	unsigned int bytes = (opcode & 0x000F) == 0 ? 32 : opcode & 0x000F;
+	for (unsigned int lane = 1; !memoryUniform && lane < instanceCount; lane++)
+	{
+		for (unsigned int i = 0; i < bytes; i++)
+		{
+			if (memory[lane * 4096 + ((I[0] + i) & 0x0FFF)] != memory[(I[0] + i) & 0x0FFF])
+			{
+				return false;
+			}
+		}
+	}
+
+	unsigned short pixels[256];
+	unsigned int count = spritePixels(&memory[0], I[0], vx[0], vy[0], opcode & 0x000F, pixels);
+	kernels->draw(screen.data(), pixels, count, row(0xF), stride);
+	return true;
+}
+
+// DXYN for a single lane
+void Chip8Lockstep::drawSprite(unsigned int lane, unsigned short opcode)
+{
+	unsigned short pixels[256];
+	unsigned char x = V[((opcode & 0x0F00) >> 8) * stride + lane];
+	unsigned char y = V[((opcode & 0x00F0) >> 4) * stride + lane];
+	unsigned int count = spritePixels(&memory[lane * 4096], I[lane], x, y, opcode & 0x000F, pixels);
+
+	unsigned char collision = 0;
+	for (unsigned int i = 0; i < count; i++)
+	{
+		unsigned char &pixel = screen[pixels[i] * stride + lane];
+		collision |= pixel;
+		pixel ^= 1;
+	}
+	V[0xF * stride + lane] = collision;
+}
+
+// 00CN scrolls the screen of a single lane down by N rows, 00FB and 00FC
+// scroll it right and left by 4 columns. The pixels scrolled in are clear.
+void Chip8Lockstep::scroll(unsigned int lane, unsigned short opcode)
+{
+	unsigned char *lanePixels = &screen[lane];
+	if ((opcode & 0xFFF0) == 0x00C0)
+	{
+		unsigned int offset = (opcode & 0x000F) * SCREEN_WIDTH;
+		for (unsigned int i = SCREEN_WIDTH * SCREEN_HEIGHT; i-- > 0;)
+		{
+			lanePixels[i * stride] = (i >= offset) ? lanePixels[(i - offset) * stride] : 0;
+		}
+		return;
+	}
+
+	for (unsigned int y = 0; y < SCREEN_HEIGHT; y++)
+	{
+		unsigned char *pixels = lanePixels + y * SCREEN_WIDTH * stride;
+		for (unsigned int i = 0; i < SCREEN_WIDTH; i++)
+		{
+			if (opcode == 0x00FB)
+			{
+				unsigned int x = SCREEN_WIDTH - 1 - i;
+				pixels[x * stride] = (x >= 4) ? pixels[(x - 4) * stride] : 0;
+			}
+			else
+			{
+				pixels[i * stride] = (i < SCREEN_WIDTH - 4) ? pixels[(i + 4) * stride] : 0;
+			}
+		}
+	}
+}
+
+// Stops a lane at the instruction it is executing, like Chip8 stops at a
+// fault. The lane is skipped from now on.
+void Chip8Lockstep::stop(unsigned int lane, Chip8Fault fault)
+{
+	faults[lane] = fault;
+	faultPcs[lane] = pc[lane];
+	++faultCount;
+}
+
+// Advances the program counters and timers of all lanes
+void Chip8Lockstep::finishCycle()
+{
+	for (unsigned int lane = 0; lane < stride; lane++)
+	{
+		pc[lane] += 2;
+	}
+	kernels->decrement(delay_timer.data(), stride);
+	kernels->decrement(sound_timer.data(), stride);
+}
+
+// Checks whether the program counters of all running lanes are equal again
+void Chip8Lockstep::checkUniformPc()
+{
+	pcUniform = true;
+	while (leader < instanceCount && faults[leader] != Chip8Fault::None)
+	{
+		++leader;
+	}
+
+	for (unsigned int lane = leader + 1; lane < instanceCount; lane++)
+	{
+		if (faults[lane] == Chip8Fault::None && pc[lane] != pc[leader])
+		{
+			pcUniform = false;
+			return;
+		}
+	}
+}
+
+// Emulates one cycle of every running instance. Once every instance has
+// stopped (or without instances), there is nothing to emulate. The program
+// counters and timers of stopped lanes still advance with the others, but
+// nothing reads them any more.
+void Chip8Lockstep::EmulateCycle()
+{
+	if (faultCount == instanceCount)
+	{
+		return;
+	}
+
+	unsigned int stopped = faultCount;
+	unsigned short opcode;
+	if (fetchUniform(opcode))
+	{
+		bool vectorized = executeVector(opcode);
+		if (!vectorized)
+		{
+			for (unsigned int lane = 0; lane < instanceCount; lane++)
+			{
+				if (faults[lane] == Chip8Fault::None)
+				{
+					executeLane(lane, opcode);
+				}
+			}
+		}
+		finishCycle();
+
+		if (!vectorized && (mayDiverge(opcode) || faultCount != stopped))
+		{
+			checkUniformPc();
+		}
+		++lockstepCycles;
+	}
+	else
+	{
+		for (unsigned int lane = 0; lane < instanceCount; lane++)
+		{
+			if (faults[lane] == Chip8Fault::None)
+			{
+				const unsigned char *laneMemory = &memory[lane * 4096];
+				unsigned short address = pc[lane];
+				executeLane(lane, laneMemory[address & 0x0FFF] << 8 | laneMemory[(address + 1) & 0x0FFF]);
+			}
+		}
+		finishCycle();
+		checkUniformPc();
+		++divergentCycles;
+	}
+}
+
+// Emulates the given number of cycles of every instance
+void Chip8Lockstep::Run(unsigned int cycles)
+{
+	for (unsigned int i = 0; i < cycles; i++)
+	{
+		EmulateCycle();
+	}
+}
@@ -0,0 +1,108 @@
+/**
+ *	@file	chip8_lockstep.h
+ *	@author	Dejan Azinovic (dazinovic)
+ *	@date	18.10.2026
+ *
+ *	Header file for the Chip8Lockstep class. The class emulates many Chip-8
+ *	instances at once. Registers, timers and program counters are stored in
+ *	structure-of-arrays form so that instances whose program counters
+ *	coincide can execute the same instruction with SIMD, one lane per
+ *	instance. Instances that diverge fall back to a scalar interpreter until
+ *	they meet again. The screens are stored pixel by pixel with one lane per
+ *	instance as well, so a sprite that every instance draws to the same
+ *	position flips each of its pixels in all screens with one SIMD XOR. The
+ *	SIMD kernels are bound by Chip8Cpu (chip8_cpu.h) when an engine is
+ *	created.
+ *
+ *	Every instance behaves like a Chip8 (wrapping access, default quirks) in
+ *	the 64x32 mode, including SUPER-CHIP's 16x16 sprites, big font, scrolls
+ *	and user flags. The instances have no 128x64 screen, so 00FF faults like
+ *	an illegal opcode does. An instance that faults stops, and the others
+ *	run on.
+ */
+
+#ifndef CHIP8_LOCKSTEP
+#define CHIP8_LOCKSTEP
+
+#include "chip8_access.h"
+#include "chip8_cpu.h"
+#include "chip8_events.h"
+#include <cstddef>
+#include <vector>
+
+struct Chip8LaneKernels;
+
+class Chip8Lockstep {
+	public:
+		Chip8Lockstep(unsigned int instanceCount);
+		~Chip8Lockstep();
+
+		const static unsigned int SCREEN_WIDTH  = 64;
+		const static unsigned int SCREEN_HEIGHT = 32;
+		const static unsigned int LANE_GROUP    = 64;	// Lane arrays are padded to a multiple of one AVX-512 register of bytes.
+
+		void EmulateCycle();									// Emulate one cycle of every instance.
+		void Run(unsigned int cycles);							// Emulate the given number of cycles of every instance.
+		bool LoadApplication(const char *filename);				// Load a Chip-8 application from disk into the memory of every instance.
+		bool LoadApplication(const unsigned char *application, size_t length);	// Load a Chip-8 application from a buffer into the memory of every instance.
+		void SetEventSink(Chip8EventSink *sink) { events = sink; }	// Receives load errors (may be null).
+
+		unsigned int GetInstanceCount() const { return instanceCount; }
+		unsigned char GetPixel(unsigned int instance, unsigned int x, unsigned int y) const { return screen[(y * SCREEN_WIDTH + x) * stride + instance]; }	// Pixel state of one instance.
+		void CopyScreen(unsigned int instance, unsigned char *pixels) const;			// Copies the screen of one instance, one byte per pixel (SCREEN_WIDTH * SCREEN_HEIGHT bytes).
+		unsigned char *GetKeys(unsigned int instance) { return &keys[instance * 16]; }									// Key state of one instance.
+		unsigned char ReadMemory(unsigned int instance, unsigned short address) const { return memory[instance * 4096 + (address & 0x0FFF)]; }	// Reads one byte of the memory of one instance.
+		Chip8Fault GetFault(unsigned int instance) const { return faults[instance]; }			// Fault that stopped one instance.
+		unsigned short GetFaultPc(unsigned int instance) const { return faultPcs[instance]; }	// Address of the instruction that stopped one instance.
+
+		unsigned long long GetLockstepCycles() const { return lockstepCycles; }		// Cycles executed with SIMD across all instances.
+		unsigned long long GetDivergentCycles() const { return divergentCycles; }	// Cycles executed by the scalar fallback.
+		Chip8Simd GetSimd() const;													// Instruction set of the SIMD kernels.
+
+	private:
+		unsigned int instanceCount;		// Number of emulated instances.
+		unsigned int stride;			// Lane count rounded up to LANE_GROUP.
+		const Chip8LaneKernels *kernels;	// SIMD kernels for the instruction set of the CPU.
+		Chip8EventSink *events;			// Sink for load errors, or null.
+
+		// Per-lane state, indexed [lane] or [register * stride + lane].
+		std::vector<unsigned char>  V;				// V-regs (V0-VF) of every instance.
+		std::vector<unsigned short> I;				// Index registers.
+		std::vector<unsigned short> pc;				// Program counters.
+		std::vector<unsigned short> sp;				// Stack pointers.
+		std::vector<unsigned short> stack;			// Stacks (16 levels).
+		std::vector<unsigned char>  delay_timer;	// Delay timers.
+		std::vector<unsigned char>  sound_timer;	// Sound timers.
+		std::vector<unsigned char>  screen;			// Screens, indexed [(y * SCREEN_WIDTH + x) * stride + lane].
+
+		// Per-instance state, indexed [instance * size + offset].
+		std::vector<unsigned char>  memory;			// Memory (size = 4k per instance).
+		std::vector<unsigned char>  keys;			// Key state of every instance.
+		std::vector<unsigned char>  flags;			// SUPER-CHIP user flags of every instance (FX75/FX85).
+		std::vector<Chip8Fault>     faults;			// Fault that stopped every instance.
+		std::vector<unsigned short> faultPcs;		// Address of the instruction that caused the fault.
+
+		bool pcUniform;					// Whether the program counters of all running instances are known to be equal.
+		bool memoryUniform;				// Whether all memories are known to be equal.
+		unsigned int faultCount;		// Number of stopped instances.
+		unsigned int leader;			// First running instance, which the others are compared to.
+
+		unsigned long long lockstepCycles;
+		unsigned long long divergentCycles;
+
+		void init();
+		void raise(Chip8EventType type, unsigned int data);		// Reports an event to the sink, if any.
+		bool fetchUniform(unsigned short &opcode) const;		// Fetches the opcode shared by all lanes, if there is one.
+		bool executeVector(unsigned short opcode);				// Executes an opcode across all lanes with SIMD, if possible.
+		void executeLane(unsigned int lane, unsigned short opcode);	// Executes an opcode for a single lane.
+		bool drawUniform(unsigned short opcode);				// DXYN across all lanes, if they all draw the same sprite to the same position.
+		void drawSprite(unsigned int lane, unsigned short opcode);	// DXYN for a single lane.
+		void scroll(unsigned int lane, unsigned short opcode);		// 00CN, 00FB and 00FC for a single lane.
+		void stop(unsigned int lane, Chip8Fault fault);			// Stops a lane at the instruction it is executing.
+		void finishCycle();										// Advances program counters and timers of all lanes.
+		void checkUniformPc();									// Rescans the program counters after control flow diverged or a lane stopped.
+
+		unsigned char *row(unsigned int reg) { return &V[reg * stride]; }
+};
+
+#endif
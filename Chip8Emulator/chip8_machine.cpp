@@ -0,0 +1,52 @@
+/**
+ *	@file	chip8_machine.cpp
+ *	@author	Dejan Azinovic (dazinovic)
+ *	@date	18.10.2026
+ *
+ *	Contains an implementation of all methods from the chip8_machine header.
+ */
+
+#include "chip8_machine.h"
+#include <cstring>
+
+// Creates the core instantiated for the platform
+std::unique_ptr<Chip8Machine> Chip8Machine::Create(Chip8Platform platform)
+{
+	switch (platform)
+	{
+	case Chip8Platform::Vip:
+		return std::unique_ptr<Chip8Machine>(new Chip8MachineOf<Chip8Vip>(platform));
+	case Chip8Platform::SuperChip:
+		return std::unique_ptr<Chip8Machine>(new Chip8MachineOf<Chip8SuperChip>(platform));
+	case Chip8Platform::XoChip:
+		{
+			Chip8MachineOf<Chip8XoChip> *machine = new Chip8MachineOf<Chip8XoChip>(platform);
+			machine->GetCore().SetXoChip(true);
+			return std::unique_ptr<Chip8Machine>(machine);
+		}
+	default:
+		return std::unique_ptr<Chip8Machine>(new Chip8MachineOf<Chip8>(platform));
+	}
+}
+
+// Parses the name of a platform
+bool Chip8Machine::ParsePlatform(const char *name, Chip8Platform &platform)
+{
+	static const struct { const char *name; Chip8Platform platform; } names[] =
+	{
+		{ "chip8", Chip8Platform::Default },
+		{ "vip", Chip8Platform::Vip },
+		{ "schip", Chip8Platform::SuperChip },
+		{ "xochip", Chip8Platform::XoChip }
+	};
+
+	for (unsigned int i = 0; i < sizeof(names) / sizeof(names[0]); i++)
+	{
+		if (strcmp(name, names[i].name) == 0)
+		{
+			platform = names[i].platform;
+			return true;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,117 @@
+/**
+ *	@file	chip8_machine.h
+ *	@author	Dejan Azinovic (dazinovic)
+ *	@date	18.10.2026
+ *
+ *	Header file for the Chip8Machine class, which selects a quirk profile at
+ *	run time. Every profile is a separate instantiation of Chip8Core, so the
+ *	quirks cost nothing inside the core; Chip8Machine only adds one virtual
+ *	call per Run, RunFrame or EmulateCycle. All three go through
+ *	Chip8Tiered, so hot blocks run predecoded and single steps still demote
+ *	the blocks they write into. Every loaded application is analyzed by
+ *	Chip8Analyzer first. Create a machine for a platform with
+ *	Chip8Machine::Create.
+ */
+
+#ifndef CHIP8_MACHINE
+#define CHIP8_MACHINE
+
+#include "chip8.h"
+#include "chip8_tiered.h"
+#include <memory>
+#include <vector>
+
+enum class Chip8Platform : unsigned char {
+	Default,		// Chip8DefaultQuirks.
+	Vip,			// Chip8VipQuirks.
+	SuperChip,		// Chip8SuperChipQuirks.
+	XoChip			// Chip8XoChipQuirks, with the XO-CHIP extensions enabled.
+};
+
+class Chip8Machine {
+	public:
+		virtual ~Chip8Machine() {}
+
+		static std::unique_ptr<Chip8Machine> Create(Chip8Platform platform);		// Creates the core instantiated for the platform.
+		static bool ParsePlatform(const char *name, Chip8Platform &platform);	// Parses "chip8", "vip", "schip" or "xochip".
+
+		virtual void EmulateCycle() = 0;
+		virtual unsigned int Run(unsigned int cycles) = 0;
+		virtual unsigned int RunFrame(unsigned int cycles) = 0;
+		virtual bool LoadApplication(const char *filename) = 0;
+		virtual bool LoadApplication(const unsigned char *application, size_t length) = 0;
+		virtual void Reset() = 0;
+		virtual void SetEventSink(Chip8EventSink *sink) = 0;
+
+		virtual unsigned int GetScreenWidth() const = 0;
+		virtual unsigned int GetScreenHeight() const = 0;
+		virtual unsigned char GetPixel(unsigned int x, unsigned int y) const = 0;
+		virtual const unsigned char *GetScreenRow(unsigned int y, unsigned int plane = 0) const = 0;
+		virtual unsigned char ReadMemory(unsigned short address) const = 0;
+
+		virtual Chip8Fault GetFault() const = 0;
+		virtual unsigned short GetFaultPc() const = 0;
+		virtual unsigned long long GetCycleCount() const = 0;
+		virtual const Chip8Analysis &GetAnalysis() const = 0;	// Static analysis of the memory image (the last loaded application, if not reset since).
+
+		virtual unsigned char *GetKeys() = 0;		// Key state for all 16 keys of the emulator keypad.
+		Chip8Platform GetPlatform() const { return platform; }
+
+	protected:
+		Chip8Machine(Chip8Platform platform) : platform(platform) {}
+
+	private:
+		Chip8Platform platform;
+};
+
+// A machine running one core instantiation
+template <class Core>
+class Chip8MachineOf : public Chip8Machine {
+	public:
+		Chip8MachineOf(Chip8Platform platform) : Chip8Machine(platform), tiered(core), analysis() { analyze(); }
+
+		void EmulateCycle() override { tiered.EmulateCycle(); }
+		unsigned int Run(unsigned int cycles) override { return tiered.Run(cycles); }
+		unsigned int RunFrame(unsigned int cycles) override { return tiered.RunFrame(cycles); }
+		bool LoadApplication(const char *filename) override { tiered.Invalidate(); return core.LoadApplication(filename) && analyze(); }
+		bool LoadApplication(const unsigned char *application, size_t length) override { tiered.Invalidate(); return core.LoadApplication(application, length) && analyze(); }
+		void Reset() override { core.Reset(); tiered.Invalidate(); analyze(); }
+		void SetEventSink(Chip8EventSink *sink) override { core.SetEventSink(sink); }
+
+		unsigned int GetScreenWidth() const override { return core.GetScreenWidth(); }
+		unsigned int GetScreenHeight() const override { return core.GetScreenHeight(); }
+		unsigned char GetPixel(unsigned int x, unsigned int y) const override { return core.GetPixel(x, y); }
+		const unsigned char *GetScreenRow(unsigned int y, unsigned int plane = 0) const override { return core.GetScreenRow(y, plane); }
+		unsigned char ReadMemory(unsigned short address) const override { return core.ReadMemory(address); }
+
+		Chip8Fault GetFault() const override { return core.GetFault(); }
+		unsigned short GetFaultPc() const override { return core.GetFaultPc(); }
+		unsigned long long GetCycleCount() const override { return core.GetCycleCount(); }
+		const Chip8Analysis &GetAnalysis() const override { return analysis; }
+
+		unsigned char *GetKeys() override { return core.keys; }
+
+		Core &GetCore() { return core; }		// The core itself, for calls without the virtual dispatch.
+		Chip8Tiered<Core> &GetTiered() { return tiered; }	// The tiers running the core.
+
+	private:
+		Core              core;
+		Chip8Tiered<Core> tiered;
+		Chip8Analysis     analysis;
+
+		// Analyzes the memory image after loading an application or a reset
+		bool analyze()
+		{
+			unsigned int size = core.IsXoChip() ? Core::XO_MEMORY_SIZE : Core::MEMORY_SIZE;
+			std::vector<unsigned char> image(size);
+			for (unsigned int address = 0; address < size; address++)
+			{
+				image[address] = core.ReadMemory((unsigned short)address);
+			}
+			analysis = Chip8Analyzer::Analyze<typename Core::QuirkProfile>(image.data(), size);
+			tiered.SetAnalysis(analysis);
+			return true;
+		}
+};
+
+#endif
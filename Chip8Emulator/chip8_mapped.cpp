@@ -0,0 +1,117 @@
+/**
+ *	@file	chip8_mapped.cpp
+ *	@author	Dejan Azinovic (dazinovic)
+ *	@date	18.10.2026
+ *
+ *	Contains an implementation of all methods from the chip8_mapped header.
+ */
+
+#include "chip8_mapped.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+Chip8MappedFile::Chip8MappedFile() : data(nullptr), size(0), file(INVALID_HANDLE_VALUE), mapping(nullptr)
+{
+}
+#else
+Chip8MappedFile::Chip8MappedFile() : data(nullptr), size(0), file(-1)
+{
+}
+#endif
+
+Chip8MappedFile::~Chip8MappedFile()
+{
+	Close();
+}
+
+// Creates a file of the given size and maps it writable
+bool Chip8MappedFile::Create(const char *filename, size_t size)
+{
+	Close();
+	if (size == 0)
+	{
+		return false;
+	}
+
+#ifdef _WIN32
+	file = CreateFileA(filename, GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	// Creating the mapping extends the file to its size
+	unsigned long long length = size;
+	mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE, static_cast<DWORD>(length >> 32), static_cast<DWORD>(length), nullptr);
+	if (mapping != nullptr)
+	{
+		data = static_cast<unsigned char *>(MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, size));
+	}
+#else
+	file = open(filename, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (file < 0)
+	{
+		return false;
+	}
+
+	if (ftruncate(file, static_cast<off_t>(size)) == 0)
+	{
+		void *memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+		if (memory != MAP_FAILED)
+		{
+			data = static_cast<unsigned char *>(memory);
+		}
+	}
+#endif
+
+	if (data == nullptr)
+	{
+		Close();
+		return false;
+	}
+
+	this->size = size;
+	return true;
+}
+
+// Unmaps the file and closes it. Dirty pages are written back by the system.
+void Chip8MappedFile::Close()
+{
+#ifdef _WIN32
+	if (data != nullptr)
+	{
+		UnmapViewOfFile(data);
+	}
+	if (mapping != nullptr)
+	{
+		CloseHandle(mapping);
+	}
+	if (file != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(file);
+	}
+	mapping = nullptr;
+	file = INVALID_HANDLE_VALUE;
+#else
+	if (data != nullptr)
+	{
+		munmap(data, size);
+	}
+	if (file >= 0)
+	{
+		close(file);
+	}
+	file = -1;
+#endif
+
+	data = nullptr;
+	size = 0;
+}
@@ -0,0 +1,43 @@
+/**
+ *	@file	chip8_mapped.h
+ *	@author	Dejan Azinovic (dazinovic)
+ *	@date	18.10.2026
+ *
+ *	Header file for the Chip8MappedFile class. The class creates a file of a
+ *	fixed size and maps it into memory, so upscaled frames can be written by
+ *	Chip8Video::ExpandFrame or ExpandScreen straight into the page cache
+ *	without an intermediate buffer or a write call per frame.
+ */
+
+#ifndef CHIP8_MAPPED
+#define CHIP8_MAPPED
+
+#include <cstddef>
+
+class Chip8MappedFile {
+	public:
+		Chip8MappedFile();
+		~Chip8MappedFile();
+
+		bool Create(const char *filename, size_t size);		// Creates (or truncates) a file of the given size and maps it writable.
+		void Close();										// Unmaps the file and closes it.
+
+		unsigned char *GetData() const { return data; }
+		size_t GetSize() const { return size; }
+		bool IsOpen() const { return data != nullptr; }
+
+	private:
+		Chip8MappedFile(const Chip8MappedFile &);
+		Chip8MappedFile &operator=(const Chip8MappedFile &);
+
+		unsigned char *data;	// Start of the mapping, null if no file is open.
+		size_t size;			// Size of the file and the mapping.
+#ifdef _WIN32
+		void *file;				// File handle.
+		void *mapping;			// File mapping handle.
+#else
+		int file;				// File descriptor.
+#endif
+};
+
+#endif
@@ -0,0 +1,180 @@
+/**
+ *	@file	chip8_pages.h
+ *	@author	Dejan Azinovic (dazinovic)
+ *	@date	18.10.2026
+ *
+ *	Header file for the Chip8PageTable class. A page table splits a block of
+ *	emulator memory (main memory or the screen) into reference counted
+ *	256-byte pages. Copying a page table shares all of its pages; a page is
+ *	only copied when one of the sharing tables writes to it. Unwritten pages
+ *	point to a single shared page of zeros, which isn't reference counted, so
+ *	creating, clearing and destroying tables of zeros touches no atomics.
+ *	Single bytes are read and written unchecked; bulk reads and writes wrap
+ *	around at the end of the table.
+ */
+
+#ifndef CHIP8_PAGES
+#define CHIP8_PAGES
+
+#include <atomic>
+#include <cstring>
+
+struct Chip8Page {
+	const static unsigned int SIZE = 256;
+
+	unsigned char data[SIZE];
+	std::atomic<unsigned int> references;	// Number of page tables sharing this page (unused by the zero page).
+
+	// The page of zeros all page tables start out with. It lives as long as
+	// the program, and page tables never count their references to it nor
+	// write to it.
+	static Chip8Page *Zero()
+	{
+		static Chip8Page *zero = createZero();
+		return zero;
+	}
+
+	private:
+		static Chip8Page *createZero()
+		{
+			Chip8Page *page = new Chip8Page;
+			memset(page->data, 0, SIZE);
+			page->references.store(0, std::memory_order_relaxed);
+			return page;
+		}
+};
+
+template <unsigned int PageCount>
+class Chip8PageTable {
+	public:
+		const static unsigned int SIZE = PageCount * Chip8Page::SIZE;
+
+		Chip8PageTable()
+		{
+			for (unsigned int i = 0; i < PageCount; i++)
+			{
+				pages[i] = Chip8Page::Zero();
+			}
+		}
+
+		Chip8PageTable(const Chip8PageTable &other)
+		{
+			for (unsigned int i = 0; i < PageCount; i++)
+			{
+				pages[i] = acquire(other.pages[i]);
+			}
+		}
+
+		Chip8PageTable &operator=(const Chip8PageTable &other)
+		{
+			for (unsigned int i = 0; i < PageCount; i++)
+			{
+				Chip8Page *page = acquire(other.pages[i]);
+				release(pages[i]);
+				pages[i] = page;
+			}
+			return *this;
+		}
+
+		~Chip8PageTable()
+		{
+			for (unsigned int i = 0; i < PageCount; i++)
+			{
+				release(pages[i]);
+			}
+		}
+
+		// Reads one byte.
+		unsigned char Get(unsigned int address) const { return pages[address / Chip8Page::SIZE]->data[address % Chip8Page::SIZE]; }
+
+		// Writes one byte.
+		void Set(unsigned int address, unsigned char value) { WritablePage(address / Chip8Page::SIZE)[address % Chip8Page::SIZE] = value; }
+
+		// Returns a page for reading.
+		const unsigned char *Page(unsigned int page) const { return pages[page]->data; }
+
+		// Returns a page for writing, copying it first if it is shared.
+		unsigned char *WritablePage(unsigned int page)
+		{
+			if (pages[page] == Chip8Page::Zero() || pages[page]->references.load(std::memory_order_acquire) != 1)
+			{
+				unshare(page);
+			}
+			return pages[page]->data;
+		}
+
+		// Copies bytes out of the table.
+		void Read(unsigned int address, unsigned char *destination, unsigned int length) const
+		{
+			while (length > 0)
+			{
+				address %= SIZE;
+				unsigned int offset = address % Chip8Page::SIZE;
+				unsigned int chunk = (Chip8Page::SIZE - offset < length) ? Chip8Page::SIZE - offset : length;
+				memcpy(destination, Page(address / Chip8Page::SIZE) + offset, chunk);
+				address += chunk;
+				destination += chunk;
+				length -= chunk;
+			}
+		}
+
+		// Copies bytes into the table.
+		void Write(unsigned int address, const unsigned char *source, unsigned int length)
+		{
+			while (length > 0)
+			{
+				address %= SIZE;
+				unsigned int offset = address % Chip8Page::SIZE;
+				unsigned int chunk = (Chip8Page::SIZE - offset < length) ? Chip8Page::SIZE - offset : length;
+				memcpy(WritablePage(address / Chip8Page::SIZE) + offset, source, chunk);
+				address += chunk;
+				source += chunk;
+				length -= chunk;
+			}
+		}
+
+		// Zeroes the whole table by pointing every page at the shared zero page.
+		void Clear()
+		{
+			for (unsigned int i = 0; i < PageCount; i++)
+			{
+				release(pages[i]);
+				pages[i] = Chip8Page::Zero();
+			}
+		}
+
+	private:
+		Chip8Page *pages[PageCount];
+
+		// Replaces a shared page by a private copy.
+		void unshare(unsigned int page)
+		{
+			Chip8Page *copy = new Chip8Page;
+			memcpy(copy->data, pages[page]->data, Chip8Page::SIZE);
+			copy->references.store(1, std::memory_order_relaxed);
+			release(pages[page]);
+			pages[page] = copy;
+		}
+
+		// Adds a reference to a page, unless it is the zero page.
+		static Chip8Page *acquire(Chip8Page *page)
+		{
+			if (page != Chip8Page::Zero())
+			{
+				page->references.fetch_add(1, std::memory_order_relaxed);
+			}
+			return page;
+		}
+
+		// Drops a reference to a page, unless it is the zero page, and
+		// deletes the page with the last one.
+		static void release(Chip8Page *page)
+		{
+			if (page != Chip8Page::Zero() && page->references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			{
+				delete page;
+			}
+		}
+};
+
+#endif
@@ -0,0 +1,91 @@
+/**
+ *	@file	chip8_queue.h
+ *	@author	Dejan Azinovic (dazinovic)
+ *	@date	18.10.2026
+ *
+ *	Header file for the Chip8Queue class template, a bounded lock-free queue
+ *	for exactly one producer thread and one consumer thread. Neither side
+ *	ever waits: pushing into a full queue and popping from an empty queue
+ *	fail (or transfer fewer elements) instead. The capacity is rounded up to
+ *	a power of two.
+ */
+
+#ifndef CHIP8_QUEUE
+#define CHIP8_QUEUE
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+template <class T>
+class Chip8Queue {
+	public:
+		Chip8Queue(size_t capacity) : head(0), tail(0)
+		{
+			size_t size = 1;
+			while (size < capacity)
+			{
+				size *= 2;
+			}
+			elements.resize(size);
+			mask = size - 1;
+		}
+
+		// Producer: appends one element. Returns false if the queue is full.
+		bool Push(const T &element) { return Push(&element, 1) == 1; }
+
+		// Producer: appends up to count elements and returns how many fit.
+		size_t Push(const T *source, size_t count)
+		{
+			size_t t = tail.load(std::memory_order_relaxed);
+			size_t free = elements.size() - (t - head.load(std::memory_order_acquire));
+			if (count > free)
+			{
+				count = free;
+			}
+			for (size_t i = 0; i < count; i++)
+			{
+				elements[(t + i) & mask] = source[i];
+			}
+			tail.store(t + count, std::memory_order_release);
+			return count;
+		}
+
+		// Consumer: removes one element. Returns false if the queue is empty.
+		bool Pop(T &element) { return Pop(&element, 1) == 1; }
+
+		// Consumer: removes up to count elements and returns how many there were.
+		size_t Pop(T *destination, size_t count)
+		{
+			size_t h = head.load(std::memory_order_relaxed);
+			size_t available = tail.load(std::memory_order_acquire) - h;
+			if (count > available)
+			{
+				count = available;
+			}
+			for (size_t i = 0; i < count; i++)
+			{
+				destination[i] = elements[(h + i) & mask];
+			}
+			head.store(h + count, std::memory_order_release);
+			return count;
+		}
+
+		size_t GetSize() const { size_t h = head.load(std::memory_order_acquire); return tail.load(std::memory_order_acquire) - h; }	// Approximate while the other side is active.
+		size_t GetCapacity() const { return elements.size(); }
+
+	private:
+		Chip8Queue(const Chip8Queue &);
+		Chip8Queue &operator=(const Chip8Queue &);
+
+		std::vector<T> elements;
+		size_t         mask;
+
+		// Head and tail only ever grow. They are padded apart so that producer
+		// and consumer don't invalidate each other's cache line.
+		std::atomic<size_t> head;		// Index of the next element to pop (written by the consumer).
+		char                padding[64];
+		std::atomic<size_t> tail;		// Index of the next element to push (written by the producer).
+};
+
+#endif
@@ -0,0 +1,80 @@
+/**
+ *	@file	chip8_quirks.h
+ *	@author	Dejan Azinovic (dazinovic)
+ *	@date	18.10.2026
+ *
+ *	Quirk profiles for the Chip8Core class template. Chip-8 platforms
+ *	disagree on the behaviour of a handful of instructions; a profile picks
+ *	one behaviour for each of them:
+ *
+ *		SHIFT_USES_VY			8XY6/8XYE shift VY into VX (instead of shifting VX in place).
+ *		SHIFT_FLAG_FIRST		8XY6/8XYE write VF before shifting VX in place, so 8F06 and 8F0E
+ *								shift the flag (instead of VF's value before the instruction).
+ *								Only defined for in-place shifts, so it excludes SHIFT_USES_VY.
+ *		LOAD_STORE_INCREMENTS_I	FX55/FX65 leave I pointing past the last register.
+ *		JUMP_USES_VX			BXNN jumps to XNN plus VX (instead of BNNN to NNN plus V0).
+ *		CLIP_SPRITES			Sprites start at a wrapped position and are clipped at the edges
+ *								of the screen (instead of leaving every pixel to the access policy).
+ *		LOGIC_RESETS_VF			8XY1/8XY2/8XY3 set VF to 0.
+ *		DISPLAY_WAIT			DXYN waits for the vertical blank, so RunFrame ends the frame after it.
+ *
+ *	The flags are compile-time constants, so every check folds away in the
+ *	core instantiated for a profile. Chip8Machine (chip8_machine.h) selects
+ *	a profile at run time.
+ */
+
+#ifndef CHIP8_QUIRKS
+#define CHIP8_QUIRKS
+
+// The behaviour this emulator always had
+struct Chip8DefaultQuirks {
+	const static bool SHIFT_USES_VY           = false;
+	const static bool SHIFT_FLAG_FIRST        = true;
+	const static bool LOAD_STORE_INCREMENTS_I = false;
+	const static bool JUMP_USES_VX            = false;
+	const static bool CLIP_SPRITES            = false;
+	const static bool LOGIC_RESETS_VF         = false;
+	const static bool DISPLAY_WAIT            = false;
+};
+
+// The original interpreter of the COSMAC VIP
+struct Chip8VipQuirks {
+	const static bool SHIFT_USES_VY           = true;
+	const static bool SHIFT_FLAG_FIRST        = false;
+	const static bool LOAD_STORE_INCREMENTS_I = true;
+	const static bool JUMP_USES_VX            = false;
+	const static bool CLIP_SPRITES            = true;
+	const static bool LOGIC_RESETS_VF         = true;
+	const static bool DISPLAY_WAIT            = true;
+};
+
+// SUPER-CHIP 1.1 on the HP-48
+struct Chip8SuperChipQuirks {
+	const static bool SHIFT_USES_VY           = false;
+	const static bool SHIFT_FLAG_FIRST        = false;
+	const static bool LOAD_STORE_INCREMENTS_I = false;
+	const static bool JUMP_USES_VX            = true;
+	const static bool CLIP_SPRITES            = true;
+	const static bool LOGIC_RESETS_VF         = false;
+	const static bool DISPLAY_WAIT            = false;
+};
+
+// XO-CHIP as defined by Octo
+struct Chip8XoChipQuirks {
+	const static bool SHIFT_USES_VY           = true;
+	const static bool SHIFT_FLAG_FIRST        = false;
+	const static bool LOAD_STORE_INCREMENTS_I = true;
+	const static bool JUMP_USES_VX            = false;
+	const static bool CLIP_SPRITES            = false;
+	const static bool LOGIC_RESETS_VF         = false;
+	const static bool DISPLAY_WAIT            = false;
+};
+
+// SHIFT_FLAG_FIRST shifts VX after VF was written, which has no meaning
+// when VY is the one being shifted
+static_assert(!(Chip8DefaultQuirks::SHIFT_USES_VY && Chip8DefaultQuirks::SHIFT_FLAG_FIRST), "SHIFT_FLAG_FIRST requires in-place shifts");
+static_assert(!(Chip8VipQuirks::SHIFT_USES_VY && Chip8VipQuirks::SHIFT_FLAG_FIRST), "SHIFT_FLAG_FIRST requires in-place shifts");
+static_assert(!(Chip8SuperChipQuirks::SHIFT_USES_VY && Chip8SuperChipQuirks::SHIFT_FLAG_FIRST), "SHIFT_FLAG_FIRST requires in-place shifts");
+static_assert(!(Chip8XoChipQuirks::SHIFT_USES_VY && Chip8XoChipQuirks::SHIFT_FLAG_FIRST), "SHIFT_FLAG_FIRST requires in-place shifts");
+
+#endif
@@ -0,0 +1,681 @@
+/**
+ *	@file	chip8_recompiler.cpp
+ *	@author	Dejan Azinovic (dazinovic)
+ *	@date	18.10.2026
+ *
+ *	Contains an implementation of all methods from the chip8_recompiler header.
+ */
+
+#include "chip8_recompiler.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+// Formats a number as a hexadecimal C++ literal
+static std::string hex(unsigned int value, int digits = 4)
+{
+	char buffer[16];
+	snprintf(buffer, sizeof(buffer), "0x%0*X", digits, value);
+	return buffer;
+}
+
+// Index of I among the allocated registers, after V0-VF
+const static unsigned int REGISTER_I = 16;
+
+// Returns the registers an inlined instruction reads or writes
+static unsigned int registerUses(unsigned short opcode)
+{
+	unsigned int x = 1 << ((opcode & 0x0F00) >> 8);
+	unsigned int y = 1 << ((opcode & 0x00F0) >> 4);
+	unsigned int vf = 1 << 0xF;
+	unsigned int i = 1 << REGISTER_I;
+	switch (opcode & 0xF000)
+	{
+	case 0x3000: case 0x4000: case 0x6000: case 0x7000: case 0xC000: case 0xE000:
+		return x;
+	case 0x5000: case 0x9000:
+		return x | y;
+	case 0x8000:
+		return x | y | (((opcode & 0x000F) >= 0x4) ? vf : 0);
+	case 0xA000:
+		return i;
+	case 0xB000:
+		return 1;
+	case 0xF000:
+		switch (opcode & 0x00FF)
+		{
+		case 0x07: case 0x15: return x;
+		case 0x1E: return x | i | vf;
+		case 0x29: case 0x30: return x | i;
+		default: return 0;
+		}
+	default:
+		return 0;
+	}
+}
+
+// Returns the registers an inlined instruction writes
+static unsigned int registerDefs(unsigned short opcode)
+{
+	unsigned int x = 1 << ((opcode & 0x0F00) >> 8);
+	unsigned int vf = 1 << 0xF;
+	unsigned int i = 1 << REGISTER_I;
+	switch (opcode & 0xF000)
+	{
+	case 0x6000: case 0x7000: case 0xC000:
+		return x;
+	case 0x8000:
+		return x | (((opcode & 0x000F) >= 0x4) ? vf : 0);
+	case 0xA000:
+		return i;
+	case 0xF000:
+		switch (opcode & 0x00FF)
+		{
+		case 0x07: return x;
+		case 0x1E: return i | vf;
+		case 0x29: case 0x30: return i;
+		default: return 0;
+		}
+	default:
+		return 0;
+	}
+}
+
+// Host registers for the V registers and I within one block. The registers
+// a block uses most live in locals, which the C++ compiler keeps in host
+// registers. They are spilled back into the Chip8 instance where it can
+// observe them: before every call into the interpreter and at the exit of
+// the block.
+struct Chip8BlockRegisters {
+	const static unsigned int MAX_CACHED = 8;	// Locals, leaving host registers for the compiler.
+
+	std::string  names[REGISTER_I + 1];		// Expression for each register.
+	unsigned int cached;					// Registers held in locals.
+	unsigned int dirty;						// Cached registers written since the last spill.
+
+	Chip8BlockRegisters(const unsigned int *uses) : cached(0), dirty(0)
+	{
+		// Cache the most used registers, if they are used more than once
+		for (unsigned int n = 0; n < MAX_CACHED; n++)
+		{
+			unsigned int best = REGISTER_I + 1;
+			for (unsigned int r = 0; r <= REGISTER_I; r++)
+			{
+				if ((cached & (1 << r)) == 0 && uses[r] > 1 && (best > REGISTER_I || uses[r] > uses[best]))
+				{
+					best = r;
+				}
+			}
+			if (best > REGISTER_I)
+			{
+				break;
+			}
+			cached |= 1 << best;
+		}
+
+		for (unsigned int r = 0; r <= REGISTER_I; r++)
+		{
+			names[r] = (cached & (1 << r)) != 0 ? local(r) : state(r);
+		}
+	}
+
+	// Declares the locals
+	std::string Declare() const
+	{
+		std::string code;
+		for (unsigned int r = 0; r <= REGISTER_I; r++)
+		{
+			if ((cached & (1 << r)) != 0)
+			{
+				code += std::string("\t") + (r == REGISTER_I ? "unsigned short " : "unsigned char ") + local(r) + " = " + state(r) + ";\n";
+			}
+		}
+		return code;
+	}
+
+	// Writes the dirty locals back
+	std::string Spill()
+	{
+		std::string code;
+		for (unsigned int r = 0; r <= REGISTER_I; r++)
+		{
+			if ((dirty & (1 << r)) != 0)
+			{
+				code += "\t" + state(r) + " = " + local(r) + ";\n";
+			}
+		}
+		dirty = 0;
+		return code;
+	}
+
+	// Reloads the cached registers among the given ones
+	std::string Reload(unsigned int registers) const
+	{
+		std::string code;
+		for (unsigned int r = 0; r <= REGISTER_I; r++)
+		{
+			if ((registers & cached & (1 << r)) != 0)
+			{
+				code += "\t" + local(r) + " = " + state(r) + ";\n";
+			}
+		}
+		return code;
+	}
+
+	static std::string local(unsigned int r) { return r == REGISTER_I ? "i" : "v" + hex(r, 1).substr(2); }
+	static std::string state(unsigned int r) { return r == REGISTER_I ? "c.I" : "c.V[" + hex(r, 1) + "]"; }
+};
+
+Chip8Recompiler::Chip8Recompiler()
+{
+	memset(memory, 0, 4096);
+	codeBegin = 0x200;
+	codeEnd = 0x200;
+	events = nullptr;
+}
+
+Chip8Recompiler::~Chip8Recompiler()
+{
+}
+
+// Loads a Chip-8 application into memory starting from address 0x200. The
+// memory past the application is cleared, so nothing of a previously
+// loaded application is left behind.
+bool Chip8Recompiler::LoadApplication(const char *filename)
+{
+	std::ifstream in(filename, std::ios::in | std::ios::binary);
+	if (in.good())
+	{
+		in.seekg(0, std::ios::end);
+		int length = int(in.tellg());
+		if (length > 4096 - 512)
+		{
+			raise(Chip8EventType::ApplicationTooBig, (unsigned int)length);
+			return false;
+		}
+
+		if (length >= 0)
+		{
+			in.seekg(0, std::ios::beg);
+			in.read(reinterpret_cast<char *>(memory + 512), length);
+			in.close();
+
+			memset(memory + 512 + length, 0, 4096 - 512 - length);
+			codeEnd = 0x200 + length;
+			analyze();
+			return true;
+		}
+	}
+
+	raise(Chip8EventType::ApplicationNotFound, 0);
+	return false;
+}
+
+// Reports an event to the sink, if any
+void Chip8Recompiler::raise(Chip8EventType type, unsigned int data) const
+{
+	if (events != nullptr)
+	{
+		Chip8Event event = { type, 0x200, data, 0, {} };
+		events->Push(event);
+	}
+}
+
+// Whether the opcode is a Chip-8 or SUPER-CHIP instruction (decoded like
+// Chip8). XO-CHIP instructions are left to the interpreter.
+bool Chip8Recompiler::isLegal(unsigned short opcode)
+{
+	switch (opcode & 0xF000)
+	{
+	case 0x0000:
+		return (opcode & 0xFFF0) == 0x00C0 || opcode == 0x00E0 || opcode == 0x00EE ||
+			(opcode >= 0x00FB && opcode <= 0x00FF && opcode != 0x00FD);
+	case 0x5000: case 0x9000:
+		return (opcode & 0x000F) == 0;
+	case 0x8000:
+		return (opcode & 0x000F) < 8 || (opcode & 0x000F) == 0x000E;
+	case 0xE000:
+		return (opcode & 0x00FF) == 0x009E || (opcode & 0x00FF) == 0x00A1;
+	case 0xF000:
+		switch (opcode & 0x00FF)
+		{
+		case 0x07: case 0x0A: case 0x15: case 0x18: case 0x1E:
+		case 0x29: case 0x30: case 0x33: case 0x55: case 0x65:
+		case 0x75: case 0x85:
+			return true;
+		default:
+			return false;
+		}
+	default:
+		return true;
+	}
+}
+
+// Whether the opcode transfers control somewhere other than the next instruction
+bool Chip8Recompiler::endsBlock(unsigned short opcode)
+{
+	if (!isLegal(opcode))
+	{
+		return true;						// The interpreter traps illegal opcodes and runs XO-CHIP opcodes
+	}
+
+	switch (opcode & 0xF000)
+	{
+	case 0x0000:
+		return opcode == 0x00EE;
+	case 0x1000: case 0x2000: case 0x3000: case 0x4000:
+	case 0x5000: case 0x9000: case 0xB000: case 0xE000:
+		return true;
+	case 0xF000:
+		return (opcode & 0x00FF) == 0x000A;	// FX0A repeats itself until a key is pressed
+	default:
+		return false;
+	}
+}
+
+// Finds all instructions reachable from 0x200 and splits them into basic blocks
+void Chip8Recompiler::analyze()
+{
+	instructions.clear();
+	leaders.clear();
+	blocks.clear();
+
+	std::vector<unsigned short> worklist(1, codeBegin);
+	leaders.insert(codeBegin);
+
+	while (!worklist.empty())
+	{
+		unsigned short address = worklist.back();
+		worklist.pop_back();
+
+		for (; contains(address); address += 2)
+		{
+			if (instructions.count(address) != 0)
+			{
+				// Another path already decoded from here, so a block starts here
+				leaders.insert(address);
+				break;
+			}
+			instructions.insert(address);
+
+			unsigned short opcode = fetch(address);
+			if (!endsBlock(opcode))
+			{
+				continue;
+			}
+			if (!isLegal(opcode))
+			{
+				break;
+			}
+
+			std::vector<unsigned short> successors;
+			switch (opcode & 0xF000)
+			{
+			case 0x1000:
+				successors.push_back(opcode & 0x0FFF);
+				break;
+			case 0x2000:
+				successors.push_back(opcode & 0x0FFF);
+				successors.push_back(address + 2);
+				break;
+			case 0x3000: case 0x4000: case 0x5000: case 0x9000: case 0xE000:
+				successors.push_back(address + 2);
+				successors.push_back(address + 4);
+				break;
+			case 0xF000:
+				successors.push_back(address);
+				successors.push_back(address + 2);
+				break;
+			default:
+				break;		// 00EE and BNNN have no static successors
+			}
+
+			for (size_t i = 0; i < successors.size(); i++)
+			{
+				leaders.insert(successors[i]);
+				worklist.push_back(successors[i]);
+			}
+			break;
+		}
+	}
+
+	for (std::set<unsigned short>::const_iterator it = leaders.begin(); it != leaders.end(); ++it)
+	{
+		unsigned short address = *it;
+		if (instructions.count(address) == 0)
+		{
+			continue;
+		}
+
+		do
+		{
+			unsigned short opcode = fetch(address);
+			address += 2;
+			if (endsBlock(opcode))
+			{
+				break;
+			}
+		} while (instructions.count(address) != 0 && leaders.count(address) == 0);
+
+		blocks[*it] = address;
+	}
+}
+
+// Writes the translation unit for the application to disk
+bool Chip8Recompiler::Translate(const char *filename, const std::string &name) const
+{
+	std::ofstream out(filename, std::ios::out | std::ios::trunc);
+	if (!out.good())
+	{
+		raise(Chip8EventType::OutputNotWritable, 0);
+		return false;
+	}
+
+	Translate(out, name);
+	return out.good();
+}
+
+// Writes the translation unit for the application to a stream
+void Chip8Recompiler::Translate(std::ostream &out, const std::string &name) const
+{
+	std::string type = "Chip8Translation<" + name + "Application>";
+
+	out << "// Generated by Chip8Recompiler. Do not edit.\n"
+		<< "// " << blocks.size() << " basic blocks, " << instructions.size() << " instructions.\n\n"
+		<< "#include \"chip8.h\"\n"
+		<< "#include <cstdlib>\n\n"
+		<< "struct " << name << "Application;\n\n"
+		<< "template <>\n"
+		<< "struct " << type << "\n"
+		<< "{\n"
+		<< "\tstatic unsigned int Run(Chip8 &c, unsigned int cycles);\n"
+		<< "\tstatic unsigned int storeSize(const Chip8 &c, unsigned short opcode);\n";
+	for (std::map<unsigned short, unsigned short>::const_iterator it = blocks.begin(); it != blocks.end(); ++it)
+	{
+		out << "\tstatic unsigned int block" << hex(it->first) << "(Chip8 &c);\n";
+	}
+	out << "};\n";
+
+	for (std::map<unsigned short, unsigned short>::const_iterator it = blocks.begin(); it != blocks.end(); ++it)
+	{
+		emitBlock(out, type, it->first, it->second);
+	}
+
+	out << "\nunsigned int " << type << "::Run(Chip8 &c, unsigned int cycles)\n"
+		<< "{\n"
+		<< "\tunsigned int executed = 0;\n"
+		<< "\twhile (executed < cycles && c.GetFault() == Chip8Fault::None)\n"
+		<< "\t{\n"
+		<< "\t\tif (!c.codeModified)\n"
+		<< "\t\t{\n"
+		<< "\t\t\tswitch (c.pc)\n"
+		<< "\t\t\t{\n";
+	for (std::map<unsigned short, unsigned short>::const_iterator it = blocks.begin(); it != blocks.end(); ++it)
+	{
+		out << "\t\t\tcase " << hex(it->first) << ": executed += block" << hex(it->first) << "(c); continue;\n";
+	}
+	out << "\t\t\t}\n"
+		<< "\t\t}\n\n"
+		<< "\t\t// Not a translated block, so let the interpreter handle it. A store\n"
+		<< "\t\t// into the application abandons the translation, as in the blocks.\n"
+		<< "\t\tunsigned short opcode = c.ReadMemory(c.pc) << 8 | c.ReadMemory(c.pc + 1);\n"
+		<< "\t\tunsigned short i = c.I;\n"
+		<< "\t\texecuted += c.Run(1);\n"
+		<< "\t\tunsigned int size = storeSize(c, opcode);\n"
+		<< "\t\tif (size != 0 && i < " << hex(codeEnd) << " && i + size > " << hex(codeBegin) << ")\n"
+		<< "\t\t{\n"
+		<< "\t\t\tc.codeModified = true;\n"
+		<< "\t\t}\n"
+		<< "\t}\n"
+		<< "\treturn executed;\n"
+		<< "}\n\n"
+		<< "// Returns how many bytes the interpreted opcode stored at I (FX33, FX55, 5XY2).\n"
+		<< "unsigned int " << type << "::storeSize(const Chip8 &c, unsigned short opcode)\n"
+		<< "{\n"
+		<< "\tunsigned int x = (opcode & 0x0F00) >> 8;\n"
+		<< "\tunsigned int y = (opcode & 0x00F0) >> 4;\n"
+		<< "\tif ((opcode & 0xF0FF) == 0xF033)\n"
+		<< "\t{\n"
+		<< "\t\treturn 3;\n"
+		<< "\t}\n"
+		<< "\tif ((opcode & 0xF0FF) == 0xF055)\n"
+		<< "\t{\n"
+		<< "\t\treturn x + 1;\n"
+		<< "\t}\n"
+		<< "\tif ((opcode & 0xF00F) == 0x5002 && c.IsXoChip())\n"
+		<< "\t{\n"
+		<< "\t\treturn ((x < y) ? y - x : x - y) + 1;\n"
+		<< "\t}\n"
+		<< "\treturn 0;\n"
+		<< "}\n\n"
+		<< "// Emulates at least the given number of cycles and returns how many were emulated.\n"
+		<< "unsigned int Run" << name << "(Chip8 &chip8, unsigned int cycles)\n"
+		<< "{\n"
+		<< "\treturn " << type << "::Run(chip8, cycles);\n"
+		<< "}\n";
+}
+
+// Emits the function for the basic block [start, end). Timers are only
+// brought up to date where an instruction observes them and at the end of
+// the block, which gives the same result as updating them every cycle. The
+// registers used most are kept in locals (Chip8BlockRegisters).
+void Chip8Recompiler::emitBlock(std::ostream &out, const std::string &type, unsigned short start, unsigned short end) const
+{
+	out << "\n// " << hex(start) << " - " << hex(end - 2) << "\n"
+		<< "unsigned int " << type << "::block" << hex(start) << "(Chip8 &c)\n"
+		<< "{\n";
+
+	unsigned int uses[REGISTER_I + 1] = {};
+	for (unsigned short address = start; address < end; address += 2)
+	{
+		unsigned int used = registerUses(fetch(address));
+		for (unsigned int r = 0; r <= REGISTER_I; r++)
+		{
+			uses[r] += (used >> r) & 1;
+		}
+	}
+	Chip8BlockRegisters registers(uses);
+	out << registers.Declare();
+
+	unsigned int pendingCycles = 0;
+	unsigned int executed = 0;
+	bool exited = false;
+
+	for (unsigned short address = start; address < end; address += 2)
+	{
+		unsigned short opcode = fetch(address);
+		std::string x  = registers.names[(opcode & 0x0F00) >> 8];
+		std::string y  = registers.names[(opcode & 0x00F0) >> 4];
+		std::string vf = registers.names[0xF];
+		std::string i  = registers.names[REGISTER_I];
+		unsigned int loaded = (2 << ((opcode & 0x0F00) >> 8)) - 1;	// V0 to VX, written by FX65 and FX85
+		std::string nn = hex(opcode & 0x00FF, 2);
+		std::string nnn = hex(opcode & 0x0FFF, 3);
+		std::string next = hex(address + 2);
+		std::string skip = hex(address + 4);
+		if (fetch(address + 2) == 0xF000)
+		{
+			skip = "(c.xoChip ? " + hex(address + 6) + " : " + skip + ")";	// XO-CHIP skips F000 NNNN as a whole
+		}
+		std::string call = "\tc.opcode = " + hex(opcode) + "; ";	// Follows a spill, since the interpreter reads the registers
+
+		// Flushes the timer updates of the instructions emitted so far
+		std::string flush = pendingCycles > 0 ? "\tc.updateTimers(" + std::to_string(pendingCycles) + ");\n" : "";
+
+		if (!isLegal(opcode))
+		{
+			// Leave the instruction to the interpreter, which traps it (or runs
+			// it, if it is an XO-CHIP instruction)
+			out << "\t// " << hex(address) << ": " << hex(opcode) << " (interpreted)\n"
+				<< "\tc.pc = " << hex(address) << ";\n";
+			exited = true;
+			break;
+		}
+
+		out << "\t// " << hex(address) << ": " << hex(opcode) << "\n";
+		switch (opcode & 0xF000)
+		{
+		case 0x0000:
+			if (opcode != 0x00EE)
+			{
+				out << registers.Spill() << call << "c.decodeOpcode0();\n";		// Clears, scrolls or switches the screen
+			}
+			else
+			{
+				out << registers.Spill() << call << "c.returnFromSubroutine();\n"
+					<< "\tc.pc += 2;\n";
+				exited = true;
+			}
+			break;
+		case 0x1000:
+			out << "\tc.pc = " << nnn << ";\n";
+			exited = true;
+			break;
+		case 0x2000:
+			out << registers.Spill() << "\tc.pc = " << hex(address) << ";\n"
+				<< call << "c.callSubroutine();\n"
+				<< "\tc.pc += 2;\n";
+			exited = true;
+			break;
+		case 0x3000:
+			out << "\tc.pc = (" << x << " == " << nn << ") ? " << skip << " : " << next << ";\n";
+			exited = true;
+			break;
+		case 0x4000:
+			out << "\tc.pc = (" << x << " != " << nn << ") ? " << skip << " : " << next << ";\n";
+			exited = true;
+			break;
+		case 0x5000:
+			out << "\tc.pc = (" << x << " == " << y << ") ? " << skip << " : " << next << ";\n";
+			exited = true;
+			break;
+		case 0x6000:
+			out << "\t" << x << " = " << nn << ";\n";
+			break;
+		case 0x7000:
+			out << "\t" << x << " += " << nn << ";\n";
+			break;
+		case 0x8000:
+			switch ((opcode & 0x0008) == 0 ? opcode & 0x0007 : 0x000E)
+			{
+			case 0x0: out << "\t" << x << " = " << y << ";\n";	break;
+			case 0x1: out << "\t" << x << " |= " << y << ";\n";	break;
+			case 0x2: out << "\t" << x << " &= " << y << ";\n";	break;
+			case 0x3: out << "\t" << x << " ^= " << y << ";\n";	break;
+			case 0x4:
+				out << "\t" << vf << " = (" << x << " + " << y << ") >> 8;\n"
+					<< "\t" << x << " += " << y << ";\n";
+				break;
+			case 0x5:
+				out << "\t" << vf << " = (" << x << " >= " << y << ");\n"
+					<< "\t" << x << " -= " << y << ";\n";
+				break;
+			case 0x6:
+				out << "\t" << vf << " = " << x << " & 0x01;\n"		// 8F06 shifts the flag (SHIFT_FLAG_FIRST)
+					<< "\t" << x << " >>= 1;\n";
+				break;
+			case 0x7:
+				out << "\t" << vf << " = (" << x << " <= " << y << ");\n"
+					<< "\t" << x << " = " << y << " - " << x << ";\n";
+				break;
+			case 0xE:
+				out << "\t" << vf << " = " << x << " >> 7;\n"
+					<< "\t" << x << " <<= 1;\n";
+				break;
+			}
+			break;
+		case 0x9000:
+			out << "\tc.pc = (" << x << " != " << y << ") ? " << skip << " : " << next << ";\n";
+			exited = true;
+			break;
+		case 0xA000:
+			out << "\t" << i << " = " << nnn << ";\n";
+			break;
+		case 0xB000:
+			out << "\tc.pc = " << nnn << " + " << registers.names[0] << ";\n";
+			exited = true;
+			break;
+		case 0xC000:
+			out << "\t" << x << " = rand() & " << nn << ";\n";
+			break;
+		case 0xD000:
+			out << registers.Spill() << call << "c.drawSprite();\n"
+				<< registers.Reload(1 << 0xF);
+			break;
+		case 0xE000:
+			out << "\tc.pc = (c.keys[" << x << " & 0x0F] == " << ((opcode & 0x0001) == 0 ? 1 : 0) << ") ? " << skip << " : " << next << ";\n";
+			exited = true;
+			break;
+		case 0xF000:
+			switch (opcode & 0x00FF)
+			{
+			case 0x07:
+				out << flush << "\t" << x << " = c.delay_timer;\n";
+				pendingCycles = 0;
+				break;
+			case 0x0A:
+				out << registers.Spill() << "\tc.pc = " << hex(address) << ";\n"
+					<< call << "c.getKey();\n"
+					<< "\tc.pc += 2;\n";
+				exited = true;
+				break;
+			case 0x15:
+				out << flush << "\tc.delay_timer = " << x << ";\n";
+				pendingCycles = 0;
+				break;
+			case 0x18:
+				out << flush << registers.Spill() << call << "c.setSound();\n";
+				pendingCycles = 0;
+				break;
+			case 0x1E:
+				out << "\t" << vf << " = (" << i << " + " << x << ") >> 16;\n"
+					<< "\t" << i << " += " << x << ";\n";
+				break;
+			case 0x29:
+				out << "\t" << i << " = (" << x << " & 0x0F) * 5;\n";
+				break;
+			case 0x30:
+				out << "\t" << i << " = 80 + (" << x << " & 0x0F) * 10;\n";
+				break;
+			case 0x75:
+			case 0x85:
+				out << registers.Spill() << call << ((opcode & 0x00FF) == 0x75 ? "c.storeFlags();\n" : "c.loadFlags();\n")
+					<< registers.Reload((opcode & 0x00FF) == 0x85 ? loaded : 0);
+				break;
+			case 0x33:
+			case 0x55:
+				{
+					unsigned int size = (opcode & 0x00FF) == 0x33 ? 3 : ((opcode & 0x0F00) >> 8) + 1;
+					out << registers.Spill() << call << ((opcode & 0x00FF) == 0x33 ? "c.setBCD();\n" : "c.storeRegisters();\n")
+						<< "\tif (c.I < " << hex(codeEnd) << " && c.I + " << size << " > " << hex(codeBegin) << ")\n"
+						<< "\t{\n"
+						<< "\t\tc.codeModified = true;\n"
+						<< "\t\tc.pc = " << next << ";\n"
+						<< "\t\tc.updateTimers(" << pendingCycles + 1 << ");\n"
+						<< "\t\treturn " << executed + 1 << ";\n"
+						<< "\t}\n";
+				}
+				break;
+			case 0x65:
+				out << registers.Spill() << call << "c.loadRegisters();\n"
+					<< registers.Reload(loaded);
+				break;
+			}
+			break;
+		}
+
+		registers.dirty |= registerDefs(opcode) & registers.cached;
+		++pendingCycles;
+		++executed;
+	}
+
+	if (!exited)
+	{
+		out << "\tc.pc = " << hex(end) << ";\n";
+	}
+	out << registers.Spill()
+		<< "\tc.updateTimers(" << pendingCycles << ");\n"
+		<< "\treturn " << executed << ";\n"
+		<< "}\n";
+}
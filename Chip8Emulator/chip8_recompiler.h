@@ -0,0 +1,71 @@
+/**
+ *	@file	chip8_recompiler.h
+ *	@author	Dejan Azinovic (dazinovic)
+ *	@date	18.10.2026
+ *
+ *	Header file for the Chip8Recompiler class. The class translates a Chip-8
+ *	application ahead of time into a C++ translation unit. Starting at 0x200,
+ *	it finds all statically reachable instructions, splits them into basic
+ *	blocks and emits one function per block that operates directly on the
+ *	state of a Chip8 instance. Within a block, the V registers and I used
+ *	most are kept in locals, so the C++ compiler can hold them in host
+ *	registers. They are written back only before calls into the interpreter
+ *	(drawSprite, FX55, FX65, ...) and at the exit of the block.
+ *
+ *	The generated file defines
+ *
+ *		unsigned int Run<Name>(Chip8 &chip8, unsigned int cycles);
+ *
+ *	which emulates at least the given number of cycles, or fewer if the
+ *	emulator faults, and returns how many were emulated. Whenever the
+ *	program counter is not the start of a translated block (indirect BNNN
+ *	jumps, code outside the application) the cycle is emulated by the
+ *	interpreter instead. Once the application
+ *	writes into its own code, whether from a translated block or from an
+ *	interpreted instruction, the translation is abandoned and the
+ *	interpreter takes over for good. Illegal opcodes are left to the
+ *	interpreter as well, which traps them and stops the run.
+ */
+
+#ifndef CHIP8_RECOMPILER
+#define CHIP8_RECOMPILER
+
+#include "chip8_events.h"
+#include <map>
+#include <ostream>
+#include <set>
+#include <string>
+
+class Chip8Recompiler {
+	public:
+		Chip8Recompiler();
+		~Chip8Recompiler();
+
+		bool LoadApplication(const char *filename);								// Load a Chip-8 application from disk and analyze it.
+		void SetEventSink(Chip8EventSink *sink) { events = sink; }				// Receives load and output errors (may be null).
+		bool Translate(const char *filename, const std::string &name) const;	// Write the translation unit for the application to disk.
+		void Translate(std::ostream &out, const std::string &name) const;		// Write the translation unit for the application to a stream.
+
+		size_t GetBlockCount() const { return blocks.size(); }					// Number of translated basic blocks.
+
+	private:
+		unsigned char  memory[4096];	// Memory image (application at 0x200).
+		unsigned short codeBegin;		// First address of the application.
+		unsigned short codeEnd;			// One past the last address of the application.
+		Chip8EventSink *events;			// Sink for load and output errors, or null.
+
+		std::set<unsigned short> instructions;				// Addresses of all reachable instructions.
+		std::set<unsigned short> leaders;					// Addresses that start a basic block.
+		std::map<unsigned short, unsigned short> blocks;	// Basic blocks, start address to end address (exclusive).
+
+		void analyze();
+		void raise(Chip8EventType type, unsigned int data) const;	// Reports an event to the sink, if any.
+		unsigned short fetch(unsigned short address) const { return memory[address & 0x0FFF] << 8 | memory[(address + 1) & 0x0FFF]; }
+		bool contains(unsigned short address) const { return address >= codeBegin && address + 1 < codeEnd; }
+		void emitBlock(std::ostream &out, const std::string &type, unsigned short start, unsigned short end) const;
+
+		static bool isLegal(unsigned short opcode);			// Whether the opcode is a Chip-8 instruction.
+		static bool endsBlock(unsigned short opcode);		// Whether the opcode transfers control somewhere other than the next instruction.
+};
+
+#endif
@@ -0,0 +1,408 @@
+/**
+ *	@file	chip8_recorder.cpp
+ *	@author	Dejan Azinovic (dazinovic)
+ *	@date	18.10.2026
+ *
+ *	Contains an implementation of all methods from the chip8_recorder header.
+ */
+
+#include "chip8_recorder.h"
+#include <algorithm>
+#include <chrono>
+
+// Writes a little-endian integer of the given size
+static void writeLittleEndian(std::ofstream &out, unsigned int value, unsigned int bytes)
+{
+	for (unsigned int i = 0; i < bytes; i++)
+	{
+		out.put(char((value >> (8 * i)) & 0xFF));
+	}
+}
+
+// Packs variable-length LZW codes into GIF data sub-blocks
+class Chip8GifBits {
+	public:
+		Chip8GifBits(std::ofstream &out) : out(out), bits(0), count(0), size(0) {}
+
+		// Appends a code, least significant bit first
+		void Write(unsigned int code, unsigned int length)
+		{
+			bits |= code << count;
+			count += length;
+			while (count >= 8)
+			{
+				put((unsigned char)(bits & 0xFF));
+				bits >>= 8;
+				count -= 8;
+			}
+		}
+
+		// Writes the remaining bits, the last sub-block and the terminator
+		void Flush()
+		{
+			if (count > 0)
+			{
+				put((unsigned char)(bits & 0xFF));
+			}
+			writeBlock();
+			out.put(0);
+		}
+
+	private:
+		std::ofstream &out;
+		unsigned int  bits;			// Bits not written yet.
+		unsigned int  count;		// Number of bits not written yet.
+		unsigned char block[255];
+		unsigned int  size;			// Bytes in the current sub-block.
+
+		void put(unsigned char byte)
+		{
+			block[size++] = byte;
+			if (size == sizeof(block))
+			{
+				writeBlock();
+			}
+		}
+
+		void writeBlock()
+		{
+			if (size > 0)
+			{
+				out.put(char(size));
+				out.write(reinterpret_cast<const char *>(block), size);
+				size = 0;
+			}
+		}
+};
+
+// Converts the palette to BT.601 studio-range YCbCr
+Chip8Y4mEncoder::Chip8Y4mEncoder(const std::string &filename, const unsigned int *palette) : filename(filename)
+{
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		int r = (palette[i] >> 16) & 0xFF;
+		int g = (palette[i] >> 8) & 0xFF;
+		int b = palette[i] & 0xFF;
+		colors[i][0] = (unsigned char)(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+		colors[i][1] = (unsigned char)((-38 * r - 74 * g + 112 * b + 128 + (128 << 8)) >> 8);
+		colors[i][2] = (unsigned char)((112 * r - 94 * g - 18 * b + 128 + (128 << 8)) >> 8);
+	}
+}
+
+// Creates the file and writes the stream header
+bool Chip8Y4mEncoder::Open(unsigned int width, unsigned int height, unsigned int frameRate)
+{
+	out.open(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!out.good())
+	{
+		return false;
+	}
+
+	frame.resize(3 * width * height);
+	out << "YUV4MPEG2 W" << width << " H" << height << " F" << frameRate << ":1 Ip A1:1 C444\n";
+	return true;
+}
+
+// Converts the frame once and writes it for every frame it is shown for
+void Chip8Y4mEncoder::Write(const unsigned char *pixels, unsigned int frames)
+{
+	size_t size = frame.size() / 3;
+	for (size_t i = 0; i < size; i++)
+	{
+		const unsigned char *color = colors[pixels[i] & 3];
+		frame[i] = color[0];
+		frame[size + i] = color[1];
+		frame[2 * size + i] = color[2];
+	}
+
+	for (unsigned int i = 0; i < frames; i++)
+	{
+		out.write("FRAME\n", 6);
+		out.write(reinterpret_cast<const char *>(frame.data()), frame.size());
+	}
+}
+
+// Closes the file
+void Chip8Y4mEncoder::Close()
+{
+	out.close();
+}
+
+Chip8GifEncoder::Chip8GifEncoder(const std::string &filename, const unsigned int *palette) : filename(filename), width(0), height(0), frameRate(60), frameCount(0)
+{
+	std::copy(palette, palette + 4, this->palette);
+}
+
+// Creates the file and writes the header, the palette and the loop extension
+bool Chip8GifEncoder::Open(unsigned int width, unsigned int height, unsigned int frameRate)
+{
+	out.open(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!out.good())
+	{
+		return false;
+	}
+
+	this->width = width;
+	this->height = height;
+	this->frameRate = frameRate;
+	frameCount = 0;
+	previous.assign(width * height, 0xFF);		// Differs from every frame, so the first one is stored whole.
+	codes.resize(4096 * 4);
+
+	out.write("GIF89a", 6);
+	writeLittleEndian(out, width, 2);
+	writeLittleEndian(out, height, 2);
+	out.put(char(0x91));						// Global color table of 4 colors, 2 bits per primary
+	out.put(0);									// Background color
+	out.put(0);									// Square pixels
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		writeLittleEndian(out, ((palette[i] & 0xFF) << 16) | (palette[i] & 0xFF00) | ((palette[i] >> 16) & 0xFF), 3);
+	}
+
+	out.put(char(0x21));						// Application extension: loop forever
+	out.put(char(0xFF));
+	out.put(11);
+	out.write("NETSCAPE2.0", 11);
+	out.put(3);
+	out.put(1);
+	writeLittleEndian(out, 0, 2);
+	out.put(0);
+	return true;
+}
+
+// Stores the rectangle that changed since the last frame. Delays are kept in
+// step with the emulated time, so rounding to hundredths of a second never
+// accumulates.
+void Chip8GifEncoder::Write(const unsigned char *pixels, unsigned int frames)
+{
+	unsigned int left = width, top = height, right = 0, bottom = 0;
+	for (unsigned int y = 0; y < height; y++)
+	{
+		const unsigned char *row = pixels + y * width;
+		const unsigned char *last = previous.data() + y * width;
+		for (unsigned int x = 0; x < width; x++)
+		{
+			if (row[x] != last[x])
+			{
+				left = std::min(left, x);
+				right = std::max(right, x + 1);
+				top = std::min(top, y);
+				bottom = y + 1;
+			}
+		}
+	}
+	if (left >= right)
+	{
+		// Nothing changed, but the frame still needs its duration
+		left = 0;
+		top = 0;
+		right = 1;
+		bottom = 1;
+	}
+
+	unsigned long long start = (frameCount * 100 + frameRate / 2) / frameRate;
+	frameCount += frames;
+	unsigned long long end = (frameCount * 100 + frameRate / 2) / frameRate;
+	while (end - start > 0xFFFF)
+	{
+		writeImage(pixels, left, top, right, bottom, 0xFFFF);
+		left = 0;
+		top = 0;
+		right = 1;
+		bottom = 1;
+		start += 0xFFFF;
+	}
+	writeImage(pixels, left, top, right, bottom, (unsigned int)(end - start));
+
+	std::copy(pixels, pixels + previous.size(), previous.begin());
+}
+
+// Writes the trailer and closes the file
+void Chip8GifEncoder::Close()
+{
+	if (!out.is_open())
+	{
+		return;
+	}
+
+	out.put(char(0x3B));
+	out.close();
+}
+
+// Writes one LZW-compressed image with its delay in hundredths of a second.
+// With four colors, the dictionary stores the codes that extend a code as
+// four consecutive entries.
+void Chip8GifEncoder::writeImage(const unsigned char *pixels, unsigned int left, unsigned int top, unsigned int right, unsigned int bottom, unsigned int delay)
+{
+	out.put(char(0x21));						// Graphic control extension
+	out.put(char(0xF9));
+	out.put(4);
+	out.put(char(0x04));						// Keep the image for the next one to draw over
+	writeLittleEndian(out, delay, 2);
+	out.put(0);
+	out.put(0);
+
+	out.put(char(0x2C));						// Image descriptor
+	writeLittleEndian(out, left, 2);
+	writeLittleEndian(out, top, 2);
+	writeLittleEndian(out, right - left, 2);
+	writeLittleEndian(out, bottom - top, 2);
+	out.put(0);
+
+	const unsigned int MIN_CODE_SIZE = 2;
+	const unsigned int CLEAR = 1 << MIN_CODE_SIZE;
+	const unsigned int END = CLEAR + 1;
+	out.put(char(MIN_CODE_SIZE));
+
+	Chip8GifBits bits(out);
+	std::fill(codes.begin(), codes.end(), (unsigned short)0);
+	unsigned int codeSize = MIN_CODE_SIZE + 1;
+	unsigned int lastCode = END;
+	bits.Write(CLEAR, codeSize);
+
+	unsigned int prefix = pixels[top * width + left] & 3;
+	for (unsigned int y = top; y < bottom; y++)
+	{
+		for (unsigned int x = (y == top) ? left + 1 : left; x < right; x++)
+		{
+			unsigned int pixel = pixels[y * width + x] & 3;
+			unsigned short &code = codes[prefix * 4 + pixel];
+			if (code != 0)
+			{
+				prefix = code;
+				continue;
+			}
+
+			bits.Write(prefix, codeSize);
+			code = (unsigned short)++lastCode;
+			if (lastCode >= (1u << codeSize))
+			{
+				++codeSize;
+			}
+			if (lastCode == 4095)
+			{
+				bits.Write(CLEAR, codeSize);
+				std::fill(codes.begin(), codes.end(), (unsigned short)0);
+				codeSize = MIN_CODE_SIZE + 1;
+				lastCode = END;
+			}
+			prefix = pixel;
+		}
+	}
+
+	bits.Write(prefix, codeSize);
+	bits.Write(END, codeSize);
+	bits.Flush();
+}
+
+// Puts every slot into the queue of free slots
+Chip8Recorder::Chip8Recorder(Chip8FrameEncoder &encoder, unsigned int scale, unsigned int frameRate, size_t slotCount) :
+	encoder(encoder), scale(scale), frameRate(frameRate), slots(slotCount), filled(slotCount), empty(slotCount),
+	held(0), holding(false), capturedFrames(0), distinctFrames(0), droppedFrames(0), running(false), started(false)
+{
+	for (unsigned int i = 0; i < slotCount; i++)
+	{
+		empty.Push(i);
+	}
+}
+
+Chip8Recorder::~Chip8Recorder()
+{
+	Stop();
+}
+
+// Opens the encoder at the scaled size of the high resolution screen
+bool Chip8Recorder::Start()
+{
+	if (started)
+	{
+		return true;
+	}
+	if (!encoder.Open(Chip8Screen::WIDTH * scale, Chip8Screen::HEIGHT * scale, frameRate))
+	{
+		return false;
+	}
+
+	started = true;
+	running.store(true);
+	thread = std::thread(&Chip8Recorder::run, this);
+	return true;
+}
+
+// Passes on the last frame, waits until the encoder thread has encoded every
+// frame and closes the encoder
+void Chip8Recorder::Stop()
+{
+	if (!started)
+	{
+		return;
+	}
+
+	release();
+	running.store(false);
+	thread.join();
+	encoder.Close();
+	started = false;
+}
+
+// Passes the held frame on. There is always room, since the queue holds as
+// many elements as there are slots.
+void Chip8Recorder::release()
+{
+	if (holding)
+	{
+		filled.Push(held);
+		++distinctFrames;
+		holding = false;
+	}
+}
+
+// Unpacks the planes into color indices and repeats every pixel to the
+// output size
+void Chip8Recorder::encode(const Slot &slot, std::vector<unsigned char> &pixels) const
+{
+	unsigned int factor = Chip8Screen::WIDTH / slot.width * scale;
+	unsigned int outputWidth = Chip8Screen::WIDTH * scale;
+	for (unsigned int y = 0; y < slot.height; y++)
+	{
+		unsigned char *row = pixels.data() + y * factor * outputWidth;
+		for (unsigned int x = 0; x < slot.width; x++)
+		{
+			unsigned int shift = 7 - x % 8;
+			unsigned char color = (unsigned char)(((slot.rows[0][y][x / 8] >> shift) & 1) | ((slot.rows[1][y][x / 8] >> shift) & 1) << 1);
+			memset(row + x * factor, color, factor);
+		}
+		for (unsigned int i = 1; i < factor; i++)
+		{
+			memcpy(row + i * outputWidth, row, outputWidth);
+		}
+	}
+
+	encoder.Write(pixels.data(), slot.frames);
+}
+
+// Encodes frames as they come and returns their slots. The running flag is
+// read before the queue, so frames passed on before Stop are never missed.
+void Chip8Recorder::run()
+{
+	std::vector<unsigned char> pixels(Chip8Screen::WIDTH * scale * Chip8Screen::HEIGHT * scale);
+	for (;;)
+	{
+		bool stopping = !running.load();
+		unsigned int index;
+		if (filled.Pop(index))
+		{
+			encode(slots[index], pixels);
+			empty.Push(index);
+		}
+		else if (stopping)
+		{
+			break;
+		}
+		else
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(4));
+		}
+	}
+}
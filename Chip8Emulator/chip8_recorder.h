@@ -0,0 +1,207 @@
+/**
+ *	@file	chip8_recorder.h
+ *	@author	Dejan Azinovic (dazinovic)
+ *	@date	18.10.2026
+ *
+ *	Header file for the Chip8Recorder class and its encoders. Chip8Recorder
+ *	captures the emulated screen once per emulated frame and hands the frames
+ *	to an encoder on a thread of its own, so the emulation never waits on the
+ *	encoder or the disk.
+ *
+ *	Captured frames are copied in packed form into a fixed pool of frame
+ *	slots. Slots travel to the encoder thread and back through two lock-free
+ *	queues. Identical consecutive frames (by far the most common case) are
+ *	merged on capture: a frame is only passed on once the screen changes,
+ *	together with the number of emulated frames it was shown for. If the
+ *	encoder falls so far behind that no slot is free, the new frame is
+ *	dropped and the last one is shown for longer instead. Drops are counted.
+ *
+ *	Encoders get frames of color indices at a fixed size: low resolution
+ *	frames are doubled to the size of the high resolution screen, and all
+ *	frames are scaled by an integer factor. Chip8Y4mEncoder writes an
+ *	uncompressed YUV4MPEG2 stream (every emulated frame, but converted only
+ *	once per distinct frame) and Chip8GifEncoder an animated GIF, in which a
+ *	distinct frame is stored once with its duration and only the rectangle
+ *	that changed.
+ */
+
+#ifndef CHIP8_RECORDER
+#define CHIP8_RECORDER
+
+#include "chip8_queue.h"
+#include "chip8_screen.h"
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Stores a sequence of frames of color indices (0 to 3)
+class Chip8FrameEncoder {
+	public:
+		virtual ~Chip8FrameEncoder() {}
+
+		virtual bool Open(unsigned int width, unsigned int height, unsigned int frameRate) = 0;	// Called before the first frame.
+		virtual void Write(const unsigned char *pixels, unsigned int frames) = 0;				// Stores a frame that is shown for the given number of frames.
+		virtual void Close() = 0;																// Called after the last frame.
+};
+
+// Writes an uncompressed YUV4MPEG2 stream (4:4:4, BT.601)
+class Chip8Y4mEncoder : public Chip8FrameEncoder {
+	public:
+		Chip8Y4mEncoder(const std::string &filename, const unsigned int *palette);	// Colors are given as 0xRRGGBB.
+
+		bool Open(unsigned int width, unsigned int height, unsigned int frameRate) override;
+		void Write(const unsigned char *pixels, unsigned int frames) override;
+		void Close() override;
+
+	private:
+		std::string   filename;
+		std::ofstream out;
+		unsigned char colors[4][3];			// Y, Cb and Cr of every palette color.
+		std::vector<unsigned char> frame;	// Converted planes of the current frame.
+};
+
+// Writes a looping animated GIF
+class Chip8GifEncoder : public Chip8FrameEncoder {
+	public:
+		Chip8GifEncoder(const std::string &filename, const unsigned int *palette);	// Colors are given as 0xRRGGBB.
+
+		bool Open(unsigned int width, unsigned int height, unsigned int frameRate) override;
+		void Write(const unsigned char *pixels, unsigned int frames) override;
+		void Close() override;
+
+	private:
+		std::string   filename;
+		std::ofstream out;
+		unsigned int  palette[4];
+		unsigned int  width;
+		unsigned int  height;
+		unsigned int  frameRate;
+		unsigned long long frameCount;		// Frames written so far, including repeats.
+		std::vector<unsigned char> previous;	// Pixels of the last frame, to find the rectangle that changed.
+		std::vector<unsigned short> codes;		// LZW dictionary, four entries per code.
+
+		void writeImage(const unsigned char *pixels, unsigned int left, unsigned int top, unsigned int right, unsigned int bottom, unsigned int delay);
+};
+
+class Chip8Recorder {
+	public:
+		Chip8Recorder(Chip8FrameEncoder &encoder, unsigned int scale = 1, unsigned int frameRate = 60, size_t slotCount = 64);
+		~Chip8Recorder();
+
+		template <class Screen>
+		void Capture(const Screen &screen, unsigned int frames = 1);	// Emulation thread: records the screen as shown for the given number of emulated frames.
+
+		bool Start();		// Opens the encoder and starts the encoder thread.
+		void Stop();		// Encodes the remaining frames, stops the encoder thread and closes the encoder.
+
+		unsigned long long GetFrames() const { return capturedFrames; }											// Emulated frames captured.
+		unsigned long long GetDistinctFrames() const { return distinctFrames; }							// Frames passed on to the encoder.
+		unsigned long long GetDroppedFrames() const { return droppedFrames.load(std::memory_order_relaxed); }	// Changed frames dropped because no slot was free.
+		size_t GetPendingFrames() const { return filled.GetSize(); }										// Frames waiting for the encoder.
+
+	private:
+		Chip8Recorder(const Chip8Recorder &);
+		Chip8Recorder &operator=(const Chip8Recorder &);
+
+		const static unsigned int PLANE_COUNT = 2;
+
+		struct Slot
+		{
+			unsigned int  width;		// Size of the screen in the resolution it was captured in.
+			unsigned int  height;
+			unsigned int  frames;		// Emulated frames the screen was shown for.
+			unsigned char rows[PLANE_COUNT][Chip8Screen::HEIGHT][Chip8Screen::ROW_SIZE];	// Packed pixels of every plane.
+		};
+
+		Chip8FrameEncoder &encoder;
+		unsigned int scale;
+		unsigned int frameRate;
+
+		std::vector<Slot>          slots;
+		Chip8Queue<unsigned int>   filled;		// Slots with frames for the encoder thread.
+		Chip8Queue<unsigned int>   empty;		// Slots the encoder thread is done with.
+		unsigned int               held;		// Slot of the latest frame, passed on once the screen changes (emulation thread).
+		bool                       holding;		// Whether held is in use.
+		unsigned long long         capturedFrames;
+		unsigned long long         distinctFrames;
+		std::atomic<unsigned long long> droppedFrames;
+
+		std::thread       thread;
+		std::atomic<bool> running;
+		bool              started;
+
+		template <class Screen>
+		bool matches(const Slot &slot, const Screen &screen) const;	// Whether the slot holds the screen.
+		void release();			// Passes the held frame on to the encoder thread.
+		void encode(const Slot &slot, std::vector<unsigned char> &pixels) const;	// Converts a slot to color indices and encodes it.
+		void run();				// Encoder thread loop.
+};
+
+// Records one emulated screen. Only copies the screen if it changed.
+template <class Screen>
+void Chip8Recorder::Capture(const Screen &screen, unsigned int frames)
+{
+	if (!started || frames == 0)
+	{
+		return;
+	}
+	capturedFrames += frames;
+
+	if (holding && matches(slots[held], screen))
+	{
+		slots[held].frames += frames;
+		return;
+	}
+
+	unsigned int index;
+	if (!empty.Pop(index))
+	{
+		if (holding)
+		{
+			slots[held].frames += frames;
+		}
+		droppedFrames.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	release();
+	Slot &slot = slots[index];
+	slot.width = screen.GetScreenWidth();
+	slot.height = screen.GetScreenHeight();
+	slot.frames = frames;
+	for (unsigned int plane = 0; plane < PLANE_COUNT; plane++)
+	{
+		for (unsigned int y = 0; y < slot.height; y++)
+		{
+			memcpy(slot.rows[plane][y], screen.GetScreenRow(y, plane), slot.width / 8);
+		}
+	}
+	held = index;
+	holding = true;
+}
+
+// Compares the visible part of every row
+template <class Screen>
+bool Chip8Recorder::matches(const Slot &slot, const Screen &screen) const
+{
+	if (slot.width != screen.GetScreenWidth() || slot.height != screen.GetScreenHeight())
+	{
+		return false;
+	}
+	for (unsigned int plane = 0; plane < PLANE_COUNT; plane++)
+	{
+		for (unsigned int y = 0; y < slot.height; y++)
+		{
+			if (memcmp(slot.rows[plane][y], screen.GetScreenRow(y, plane), slot.width / 8) != 0)
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+#endif
@@ -0,0 +1,198 @@
+/**
+ *	@file	chip8_screen.h
+ *	@author	Dejan Azinovic (dazinovic)
+ *	@date	18.10.2026
+ *
+ *	Header file for the Chip8Screen class, the packed framebuffer of the
+ *	emulator (or of one XO-CHIP bitplane). Every row of the 128x64
+ *	SUPER-CHIP screen is stored as 16 bytes with one bit per pixel, the
+ *	leftmost pixel in the top bit of the first byte (the bit order of
+ *	sprites). The low resolution 64x32 screen uses the top left quarter.
+ *
+ *	Sprites are XORed into the bytes they cover, with the shifted sprite bytes
+ *	looked up in a table that is generated at compile time. Horizontal
+ *	scrolls work on a row as two 64-bit words, and vertical scrolls move
+ *	whole rows with memmove. The rows are kept in a Chip8PageTable, so
+ *	copies of a screen share them until they are written.
+ */
+
+#ifndef CHIP8_SCREEN
+#define CHIP8_SCREEN
+
+#include "chip8_pages.h"
+#include <cassert>
+#include <cstring>
+#include <utility>
+
+// Sprite byte shifted right by 0 to 7 pixels into two bytes, for the table
+// entry offset * 256 + byte
+constexpr unsigned short Chip8SpriteShift(size_t entry)
+{
+	return (unsigned short)((entry & 0xFF) << 8 >> (entry >> 8));
+}
+
+// Table of Chip8SpriteShift for every entry, filled in by the compiler
+template <size_t... Entry>
+struct Chip8SpriteShiftTable {
+	static const unsigned short VALUES[sizeof...(Entry)];
+};
+
+template <size_t... Entry>
+const unsigned short Chip8SpriteShiftTable<Entry...>::VALUES[sizeof...(Entry)] = { Chip8SpriteShift(Entry)... };
+
+template <size_t... Entry>
+Chip8SpriteShiftTable<Entry...> Chip8MakeSpriteShiftTable(std::index_sequence<Entry...>);
+
+class Chip8Screen {
+	public:
+		const static unsigned int WIDTH    = 128;
+		const static unsigned int HEIGHT   = 64;
+		const static unsigned int ROW_SIZE = WIDTH / 8;		// Bytes per row.
+
+		// Reads one pixel.
+		unsigned char Get(unsigned int x, unsigned int y) const { return (pixels.Get(y * ROW_SIZE + x / 8) >> (7 - x % 8)) & 1; }
+
+		// Returns the packed pixels of one row.
+		const unsigned char *Row(unsigned int y) const
+		{
+			unsigned int address = y * ROW_SIZE;
+			return pixels.Page(address / Chip8Page::SIZE) + address % Chip8Page::SIZE;
+		}
+
+		// XORs a sprite row of up to 16 pixels (leftmost pixel in the top bit)
+		// into the screen. The row has to fit, x + width <= WIDTH. Returns
+		// whether a set pixel was cleared.
+		bool Draw(unsigned int x, unsigned int y, unsigned int bits, unsigned int width)
+		{
+			// Line both sprite bytes up with the (up to) three screen bytes they cover
+			unsigned int aligned = bits << (16 - width);
+			unsigned int offset = (x % 8) << 8;
+			unsigned int first = SpriteShifts::VALUES[offset | aligned >> 8];
+			unsigned int second = SpriteShifts::VALUES[offset | (aligned & 0xFF)];
+			unsigned char sprite[3] = { (unsigned char)(first >> 8), (unsigned char)(first | second >> 8), (unsigned char)second };
+			if ((sprite[0] | sprite[1] | sprite[2]) == 0)
+			{
+				return false;
+			}
+
+			// Only touch the bytes the sprite covers. A row ending in the last
+			// screen byte would otherwise reach into the next row, or past the
+			// page into its reference count.
+			assert(x / 8 + ((sprite[2] != 0) ? 3 : (sprite[1] != 0) ? 2 : 1) <= ROW_SIZE);
+			unsigned int address = y * ROW_SIZE + x / 8;
+			unsigned char *row = pixels.WritablePage(address / Chip8Page::SIZE) + address % Chip8Page::SIZE;
+			unsigned int collision = row[0] & sprite[0];
+			row[0] ^= sprite[0];
+			if (sprite[1] != 0)
+			{
+				collision |= row[1] & sprite[1];
+				row[1] ^= sprite[1];
+			}
+			if (sprite[2] != 0)
+			{
+				collision |= row[2] & sprite[2];
+				row[2] ^= sprite[2];
+			}
+			return collision != 0;
+		}
+
+		// Moves the top height rows down, clearing the rows scrolled in.
+		void ScrollDown(unsigned int rows, unsigned int height)
+		{
+			unsigned char buffer[WIDTH * HEIGHT / 8];
+			unsigned int size = height * ROW_SIZE;
+			unsigned int offset = ((rows < height) ? rows : height) * ROW_SIZE;
+			pixels.Read(0, buffer, size);
+			memmove(buffer + offset, buffer, size - offset);
+			memset(buffer, 0, offset);
+			pixels.Write(0, buffer, size);
+		}
+
+		// Moves the top height rows up, clearing the rows scrolled in.
+		void ScrollUp(unsigned int rows, unsigned int height)
+		{
+			unsigned char buffer[WIDTH * HEIGHT / 8];
+			unsigned int size = height * ROW_SIZE;
+			unsigned int offset = ((rows < height) ? rows : height) * ROW_SIZE;
+			pixels.Read(0, buffer, size);
+			memmove(buffer, buffer + offset, size - offset);
+			memset(buffer + size - offset, 0, offset);
+			pixels.Write(0, buffer, size);
+		}
+
+		// Moves the top left width x height pixels right by 1 to 63 columns.
+		void ScrollRight(unsigned int columns, unsigned int width, unsigned int height)
+		{
+			for (unsigned int y = 0; y < height; y++)
+			{
+				unsigned long long left, right;
+				load(y, left, right);
+				if ((left | right) != 0)
+				{
+					if (width > 64)
+					{
+						right = right >> columns | left << (64 - columns);
+					}
+					store(y, left >> columns, right);
+				}
+			}
+		}
+
+		// Moves the top left width x height pixels left by 1 to 63 columns.
+		void ScrollLeft(unsigned int columns, unsigned int width, unsigned int height)
+		{
+			for (unsigned int y = 0; y < height; y++)
+			{
+				unsigned long long left, right;
+				load(y, left, right);
+				if ((left | right) != 0)
+				{
+					if (width > 64)
+					{
+						left = left << columns | right >> (64 - columns);
+						right <<= columns;
+					}
+					else
+					{
+						left <<= columns;
+					}
+					store(y, left, right);
+				}
+			}
+		}
+
+		// Clears every pixel.
+		void Clear() { pixels.Clear(); }
+
+	private:
+		typedef decltype(Chip8MakeSpriteShiftTable(std::make_index_sequence<8 * 256>())) SpriteShifts;
+
+		Chip8PageTable<WIDTH * HEIGHT / 8 / Chip8Page::SIZE> pixels;	// Rows of packed pixels, copy-on-write.
+
+		// Reads a row as two words, leftmost pixel in the top bit of left.
+		void load(unsigned int y, unsigned long long &left, unsigned long long &right) const
+		{
+			const unsigned char *row = Row(y);
+			left = 0;
+			right = 0;
+			for (unsigned int i = 0; i < 8; i++)
+			{
+				left = left << 8 | row[i];
+				right = right << 8 | row[8 + i];
+			}
+		}
+
+		// Writes a row from two words.
+		void store(unsigned int y, unsigned long long left, unsigned long long right)
+		{
+			unsigned int address = y * ROW_SIZE;
+			unsigned char *row = pixels.WritablePage(address / Chip8Page::SIZE) + address % Chip8Page::SIZE;
+			for (unsigned int i = 0; i < 8; i++)
+			{
+				row[7 - i] = (unsigned char)(left >> (8 * i));
+				row[15 - i] = (unsigned char)(right >> (8 * i));
+			}
+		}
+};
+
+#endif
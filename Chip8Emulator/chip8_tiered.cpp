@@ -0,0 +1,458 @@
+/**
+ *	@file	chip8_tiered.cpp
+ *	@author	Dejan Azinovic (dazinovic)
+ *	@date	18.10.2026
+ *
+ *	Contains an implementation of all methods from the chip8_tiered header.
+ */
+
+#include "chip8_tiered.h"
+
+template <class Core>
+Chip8Tiered<Core>::Chip8Tiered(Core &core, unsigned int threshold)
+	: core(core), threshold(threshold > 0 ? threshold : 1), lastCycleCount(0), codeWriteFree(false),
+	  promotions(0), demotions(0), compiledCycles(0), interpretedCycles(0)
+{
+	Invalidate();
+}
+
+// Interprets one instruction, demoting the blocks it writes into. Single
+// steps don't count towards the promotion of a block.
+template <class Core>
+void Chip8Tiered<Core>::EmulateCycle()
+{
+	if (entries.size() != core.memorySize || core.cycleCount < lastCycleCount)
+	{
+		Invalidate();
+	}
+
+	// A faulted emulator stays stopped until it is reset
+	if (core.fault == Chip8Fault::None)
+	{
+		interpret(1);
+	}
+	lastCycleCount = core.cycleCount;
+}
+
+// Emulates up to the given number of cycles, stopping at a fault. Returns
+// the number of completed cycles.
+template <class Core>
+unsigned int Chip8Tiered<Core>::Run(unsigned int cycles)
+{
+	return run(cycles, false);
+}
+
+// Emulates one frame of the given number of cycles, waiting for its end
+// after a draw if the quirks say so. Returns the number of completed cycles.
+template <class Core>
+unsigned int Chip8Tiered<Core>::RunFrame(unsigned int cycles)
+{
+	return run(cycles, true);
+}
+
+// Demotes every block and forgets the execution counts
+template <class Core>
+void Chip8Tiered<Core>::Invalidate()
+{
+	Entry empty = { 0, 0, 0 };
+	entries.assign(core.memorySize, empty);
+	blocks.clear();
+	freeBlocks.clear();
+	lastCycleCount = core.cycleCount;
+	codeWriteFree = false;
+}
+
+// Dispatches between the tiers. Every time the program counter enters a
+// block, the block either runs from its closures or is interpreted, and its
+// execution count goes up until it is promoted.
+template <class Core>
+unsigned int Chip8Tiered<Core>::run(unsigned int cycles, bool frame)
+{
+	// A reset or another memory size leaves the blocks behind
+	if (entries.size() != core.memorySize || core.cycleCount < lastCycleCount)
+	{
+		Invalidate();
+	}
+
+	unsigned int executed = 0;
+	while (executed < cycles && core.fault == Chip8Fault::None)
+	{
+		unsigned int address = core.pc;
+		if (address < entries.size())
+		{
+			Entry &entry = entries[address];
+			if (entry.block == 0 && entry.hotness < threshold && ++entry.hotness == threshold)
+			{
+				promote(address);
+			}
+		}
+
+		if (address < entries.size() && entries[address].block != 0)
+		{
+			executed += execute(entries[address].block - 1, cycles - executed);
+		}
+		else
+		{
+			executed += interpret(cycles - executed);
+		}
+
+		// Blocks end after a draw with the DISPLAY_WAIT quirk
+		if (frame && Core::QuirkProfile::DISPLAY_WAIT && core.fault == Chip8Fault::None && (core.opcode & 0xF000) == 0xD000)
+		{
+			core.updateTimers(cycles - executed);
+			executed = cycles;
+		}
+	}
+
+	lastCycleCount = core.cycleCount;
+	return executed;
+}
+
+// Interprets instructions up to and including the next one that ends a
+// block. Returns the number of completed cycles.
+template <class Core>
+unsigned int Chip8Tiered<Core>::interpret(unsigned int cycles)
+{
+	unsigned int executed = 0;
+	while (executed < cycles)
+	{
+		unsigned int address = core.I;
+		core.step();
+		if (core.fault != Chip8Fault::None)
+		{
+			break;
+		}
+		++executed;
+
+		unsigned int length = writeSize(core.opcode);
+		if (length != 0 && !codeWriteFree)
+		{
+			written(address, length);
+		}
+		if (endsBlock(core.opcode))
+		{
+			break;
+		}
+	}
+	interpretedCycles += executed;
+	return executed;
+}
+
+// Executes a promoted block from its closures, exactly like Core::step
+// would: the program counter and the timers advance after every
+// instruction. Returns the number of completed cycles.
+template <class Core>
+unsigned int Chip8Tiered<Core>::execute(unsigned int block, unsigned int cycles)
+{
+	const Block &b = blocks[block];
+	const std::vector<Op> &ops = (!b.optimized.empty() && cycles >= b.ops.size()) ? b.optimized : b.ops;
+	unsigned int executed = 0;
+	for (size_t i = 0; i < ops.size() && executed < cycles; i++)
+	{
+		const Op &op = ops[i];
+		unsigned short address = core.pc;
+		unsigned int target = core.I;
+
+		core.opcode = op.opcode;
+		op.execute(core, op);
+		if (core.fault != Chip8Fault::None)
+		{
+			core.pc = core.faultPc = address;
+			core.raise(Chip8EventType::Fault, (unsigned int)core.fault, core.cycleCount);
+			break;
+		}
+		core.pc += 2;
+		core.updateTimers(1);
+		++executed;
+
+		// The write may have demoted this very block
+		if (op.writes != 0 && !codeWriteFree && written(target, op.writes))
+		{
+			break;
+		}
+	}
+	compiledCycles += executed;
+	return executed;
+}
+
+// Predecodes the block starting at the address
+template <class Core>
+void Chip8Tiered<Core>::promote(unsigned short address)
+{
+	if (freeBlocks.empty() && blocks.size() >= 0xFFFF)
+	{
+		return;
+	}
+
+	Block block;
+	block.start = address;
+	block.end = address;
+	block.live = true;
+	while (block.ops.size() < MAX_BLOCK_SIZE && block.end + 1 < entries.size())
+	{
+		unsigned short opcode = core.memory.Get(block.end) << 8 | core.memory.Get(block.end + 1);
+		block.ops.push_back(predecode(opcode));
+		block.end += 2;
+		if (endsBlock(opcode))
+		{
+			// The operand of F000 NNNN is code as well
+			if (opcode == 0xF000)
+			{
+				block.end = (block.end + 2 < entries.size()) ? block.end + 2 : (unsigned int)entries.size();
+			}
+			break;
+		}
+	}
+	if (block.ops.empty())
+	{
+		return;
+	}
+
+	Chip8IrBlock ir;
+	for (size_t i = 0; i < block.ops.size(); i++)
+	{
+		ir.template Append<typename Core::QuirkProfile>(block.ops[i].opcode);
+	}
+	ir.Optimize();
+	if (ir.GetChangeCount() != 0)
+	{
+		for (size_t i = 0; i < block.ops.size(); i++)
+		{
+			block.optimized.push_back(lower(ir[i], block.ops[i]));
+		}
+	}
+
+	for (unsigned int a = block.start; a < block.end; a++)
+	{
+		++entries[a].coverage;
+	}
+
+	unsigned int index;
+	if (!freeBlocks.empty())
+	{
+		index = freeBlocks.back();
+		freeBlocks.pop_back();
+		blocks[index] = std::move(block);
+	}
+	else
+	{
+		index = (unsigned int)blocks.size();
+		blocks.push_back(std::move(block));
+	}
+	entries[address].block = (unsigned short)(index + 1);
+	++promotions;
+}
+
+// Returns a block to the interpreter. Its closures stay allocated until the
+// slot is reused, so a block can demote itself while it executes.
+template <class Core>
+void Chip8Tiered<Core>::demote(unsigned int block)
+{
+	Block &b = blocks[block];
+	for (unsigned int a = b.start; a < b.end; a++)
+	{
+		--entries[a].coverage;
+	}
+	entries[b.start].block = 0;
+	entries[b.start].hotness = 0;
+	b.live = false;
+	freeBlocks.push_back((unsigned short)block);
+	++demotions;
+}
+
+// Demotes the blocks containing any of the written bytes. Returns whether
+// there were any.
+template <class Core>
+bool Chip8Tiered<Core>::written(unsigned int address, unsigned int length)
+{
+	bool demoted = false;
+	for (unsigned int i = 0; i < length; i++)
+	{
+		Chip8Fault ignored = Chip8Fault::None;
+		unsigned int a = Core::AccessPolicy::Memory(address + i, core.memorySize, ignored);
+		if (a >= entries.size() || entries[a].coverage == 0)
+		{
+			continue;
+		}
+
+		// Self-modifying code is rare, so the blocks are simply searched
+		for (unsigned int b = 0; b < blocks.size(); b++)
+		{
+			if (blocks[b].live && blocks[b].start <= a && a < blocks[b].end)
+			{
+				demote(b);
+				demoted = true;
+			}
+		}
+	}
+	return demoted;
+}
+
+// Returns whether the opcode ends a block: it changes the program counter,
+// or it draws and the frame might end after it.
+template <class Core>
+bool Chip8Tiered<Core>::endsBlock(unsigned short opcode)
+{
+	switch (opcode & 0xF000)
+	{
+	case 0x0000:
+		return opcode == 0x00EE;
+	case 0x1000:
+	case 0x2000:
+	case 0x3000:
+	case 0x4000:
+	case 0x5000:
+	case 0x9000:
+	case 0xB000:
+	case 0xE000:
+		return true;
+	case 0xD000:
+		return Core::QuirkProfile::DISPLAY_WAIT;
+	case 0xF000:
+		return (opcode & 0x00FF) == 0x000A || opcode == 0xF000;
+	default:
+		return false;
+	}
+}
+
+// Returns the number of bytes the opcode writes starting at I
+template <class Core>
+unsigned int Chip8Tiered<Core>::writeSize(unsigned short opcode)
+{
+	unsigned int x = (opcode & 0x0F00) >> 8;
+	unsigned int y = (opcode & 0x00F0) >> 4;
+	if ((opcode & 0xF00F) == 0x5002)
+	{
+		return ((x < y) ? y - x : x - y) + 1;
+	}
+	if ((opcode & 0xF0FF) == 0xF033)
+	{
+		return 3;
+	}
+	if ((opcode & 0xF0FF) == 0xF055)
+	{
+		return x + 1;
+	}
+	return 0;
+}
+
+// Predecodes one instruction into a closure. The common instructions get a
+// closure of their own, the rest call their handler directly, and whatever
+// depends on the mode of the core goes through the decode tables.
+template <class Core>
+typename Chip8Tiered<Core>::Op Chip8Tiered<Core>::predecode(unsigned short opcode)
+{
+	Op op;
+	op.execute = &Chip8Tiered::decode;
+	op.opcode = opcode;
+	op.nnn = opcode & 0x0FFF;
+	op.x = (opcode & 0x0F00) >> 8;
+	op.y = (opcode & 0x00F0) >> 4;
+	op.nn = opcode & 0x00FF;
+	op.flag = 0;
+	op.writes = (unsigned char)writeSize(opcode);
+
+	switch (opcode & 0xF000)
+	{
+	case 0x0000:
+		if (opcode == 0x00E0)		op.execute = &Chip8Tiered::call<&Core::clearScreen>;
+		else if (opcode == 0x00EE)	op.execute = &Chip8Tiered::call<&Core::returnFromSubroutine>;
+		break;
+	case 0x1000: op.execute = &Chip8Tiered::jump; break;
+	case 0x2000: op.execute = &Chip8Tiered::call<&Core::callSubroutine>; break;
+	case 0x3000: op.execute = &Chip8Tiered::call<&Core::skipInstructionIfEqualsN>; break;
+	case 0x4000: op.execute = &Chip8Tiered::call<&Core::skipInstructionIfNotEqualsN>; break;
+	case 0x6000: op.execute = &Chip8Tiered::setToN; break;
+	case 0x7000: op.execute = &Chip8Tiered::addN; break;
+	case 0x8000:
+		switch (opcode & 0x000F)
+		{
+		case 0x0: op.execute = &Chip8Tiered::assign; break;
+		case 0x1: op.execute = &Chip8Tiered::call<&Core::bitwiseOr>; break;
+		case 0x2: op.execute = &Chip8Tiered::call<&Core::bitwiseAnd>; break;
+		case 0x3: op.execute = &Chip8Tiered::call<&Core::bitwiseXor>; break;
+		case 0x4: op.execute = &Chip8Tiered::call<&Core::add>; break;
+		case 0x5: op.execute = &Chip8Tiered::call<&Core::subtract>; break;
+		case 0x6: op.execute = &Chip8Tiered::call<&Core::bitwiseShiftRight>; break;
+		case 0x7: op.execute = &Chip8Tiered::call<&Core::reverseSubtract>; break;
+		case 0xE: op.execute = &Chip8Tiered::call<&Core::bitwiseShiftLeft>; break;
+		}
+		break;
+	case 0x9000:
+		if ((opcode & 0x000F) == 0)	op.execute = &Chip8Tiered::call<&Core::skipInstructionIfNotEquals>;
+		break;
+	case 0xA000: op.execute = &Chip8Tiered::setI; break;
+	case 0xB000: op.execute = &Chip8Tiered::call<&Core::jumpToAddressPlus>; break;
+	case 0xC000: op.execute = &Chip8Tiered::call<&Core::setRandom>; break;
+	case 0xD000: op.execute = &Chip8Tiered::call<&Core::drawSprite>; break;
+	case 0xF000:
+		switch (opcode & 0x00FF)
+		{
+		case 0x07: op.execute = &Chip8Tiered::call<&Core::getDelay>; break;
+		case 0x15: op.execute = &Chip8Tiered::call<&Core::setDelay>; break;
+		case 0x18: op.execute = &Chip8Tiered::call<&Core::setSound>; break;
+		case 0x1E: op.execute = &Chip8Tiered::call<&Core::addToI>; break;
+		case 0x29: op.execute = &Chip8Tiered::call<&Core::findCharacter>; break;
+		case 0x33: op.execute = &Chip8Tiered::call<&Core::setBCD>; break;
+		case 0x55: op.execute = &Chip8Tiered::call<&Core::storeRegisters>; break;
+		case 0x65: op.execute = &Chip8Tiered::call<&Core::loadRegisters>; break;
+		}
+		break;
+	}
+	return op;
+}
+
+// Returns the closure for an optimized IR instruction. Whatever the passes
+// left unchanged keeps its exact closure.
+template <class Core>
+typename Chip8Tiered<Core>::Op Chip8Tiered<Core>::lower(const Chip8IrInst &inst, const Op &exact)
+{
+	Op op = exact;
+	op.y = inst.y;
+	switch (inst.op)
+	{
+	case Chip8IrOp::Nop:
+		op.execute = &Chip8Tiered::nop;
+		break;
+	case Chip8IrOp::Load:
+		op.nn = (unsigned char)inst.imm;
+		op.flag = inst.flag;
+		op.execute = inst.setsFlag ? &Chip8Tiered::load : &Chip8Tiered::setToN;
+		break;
+	case Chip8IrOp::Or:
+		op.execute = inst.setsFlag ? exact.execute : &Chip8Tiered::bitwiseOr;
+		break;
+	case Chip8IrOp::And:
+		op.execute = inst.setsFlag ? exact.execute : &Chip8Tiered::bitwiseAnd;
+		break;
+	case Chip8IrOp::Xor:
+		op.execute = inst.setsFlag ? exact.execute : &Chip8Tiered::bitwiseXor;
+		break;
+	case Chip8IrOp::Add:
+		op.execute = inst.setsFlag ? exact.execute : &Chip8Tiered::add;
+		break;
+	case Chip8IrOp::Sub:
+		op.execute = inst.setsFlag ? exact.execute : &Chip8Tiered::subtract;
+		break;
+	case Chip8IrOp::ReverseSub:
+		op.execute = inst.setsFlag ? exact.execute : &Chip8Tiered::reverseSubtract;
+		break;
+	case Chip8IrOp::ShiftRight:
+		op.execute = inst.setsFlag ? exact.execute : &Chip8Tiered::shiftRight;
+		break;
+	case Chip8IrOp::ShiftLeft:
+		op.execute = inst.setsFlag ? exact.execute : &Chip8Tiered::shiftLeft;
+		break;
+	case Chip8IrOp::AddI:
+		op.execute = inst.setsFlag ? exact.execute : &Chip8Tiered::addToI;
+		break;
+	default:
+		break;
+	}
+	return op;
+}
+
+template class Chip8Tiered<Chip8>;
+template class Chip8Tiered<Chip8Vip>;
+template class Chip8Tiered<Chip8SuperChip>;
+template class Chip8Tiered<Chip8XoChip>;
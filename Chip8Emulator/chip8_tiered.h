@@ -0,0 +1,145 @@
+/**
+ *	@file	chip8_tiered.h
+ *	@author	Dejan Azinovic (dazinovic)
+ *	@date	18.10.2026
+ *
+ *	Header file for the Chip8Tiered class template, which runs a core in two
+ *	tiers. Every application starts in the interpreter of the core, which
+ *	counts how often each basic block is entered. Once a block has been
+ *	entered threshold times, it is promoted: its instructions are predecoded
+ *	once into closures (a function plus its operands), and from then on the
+ *	block runs from the closures without fetching and decoding. Most of an
+ *	application is cold, so only the hot loops pay for predecoding.
+ *
+ *	A promoted block is also run through the passes of Chip8IrBlock
+ *	(chip8_ir.h), which drop dead VF results, fold constants and remove
+ *	redundant ANNN. Those closures only run when the whole block fits into
+ *	the remaining cycles, so no run ever stops inside an optimized block.
+ *
+ *	A block is demoted back to the interpreter as soon as an instruction
+ *	writes into its code (FX33, FX55, 5XY2). Both tiers execute instructions
+ *	through the same handlers and update the timers after every instruction,
+ *	so running a core tiered gives exactly the same results as Core::Run.
+ *
+ *	SetAnalysis drops those checks for an application that Chip8Analyzer
+ *	proved never writes into its code.
+ *
+ *	The tiers are rebuilt automatically after the core is reset or switched
+ *	to another memory size. Call Invalidate after loading another application
+ *	into a core without resetting it.
+ */
+
+#ifndef CHIP8_TIERED
+#define CHIP8_TIERED
+
+#include "chip8.h"
+#include "chip8_analyzer.h"
+#include "chip8_ir.h"
+#include <vector>
+
+template <class Core>
+class Chip8Tiered {
+	public:
+		Chip8Tiered(Core &core, unsigned int threshold = 16);
+
+		const static unsigned int MAX_BLOCK_SIZE = 64;	// Instructions per promoted block.
+
+		void EmulateCycle();							// Emulate one cycle with the interpreter, like Core::EmulateCycle.
+		unsigned int Run(unsigned int cycles);			// Emulate up to the given number of cycles, like Core::Run.
+		unsigned int RunFrame(unsigned int cycles);		// Emulate one frame, like Core::RunFrame.
+		void Invalidate();								// Demote every block and forget the execution counts.
+		void SetAnalysis(const Chip8Analysis &analysis) { codeWriteFree = analysis.IsCodeWriteFree(); }	// Trust the analysis of the loaded application until the next invalidation.
+
+		unsigned int GetThreshold() const { return threshold; }
+		unsigned long long GetPromotions() const { return promotions; }					// Blocks promoted so far.
+		unsigned long long GetDemotions() const { return demotions; }					// Blocks demoted by writes into their code.
+		unsigned long long GetCompiledCycles() const { return compiledCycles; }			// Cycles executed from predecoded blocks.
+		unsigned long long GetInterpretedCycles() const { return interpretedCycles; }	// Cycles executed by the interpreter.
+
+	private:
+		Chip8Tiered(const Chip8Tiered &);
+		Chip8Tiered &operator=(const Chip8Tiered &);
+
+		// One predecoded instruction
+		struct Op {
+			void (*execute)(Core &c, const Op &op);
+			unsigned short opcode;
+			unsigned short nnn;
+			unsigned char  x;
+			unsigned char  y;
+			unsigned char  nn;
+			unsigned char  flag;		// Value a folded load writes to VF.
+			unsigned char  writes;		// Bytes the instruction writes starting at I.
+		};
+
+		struct Block {
+			unsigned int    start;		// Entry address.
+			unsigned int    end;		// Address after the last byte of code.
+			std::vector<Op> ops;
+			std::vector<Op> optimized;	// The same instructions after the IR passes, empty if they changed nothing.
+			bool            live;
+		};
+
+		// Tiering state of one address
+		struct Entry {
+			unsigned short hotness;		// Times the address was entered as a block (saturates at the threshold).
+			unsigned short block;		// Index + 1 of the promoted block starting here, 0 if none.
+			unsigned short coverage;	// Number of promoted blocks containing the address.
+		};
+
+		Core               &core;
+		unsigned int       threshold;
+		std::vector<Entry> entries;			// One per memory address.
+		std::vector<Block> blocks;
+		std::vector<unsigned short> freeBlocks;	// Indices of demoted blocks that can be reused.
+		unsigned long long lastCycleCount;		// Cycle count of the core after the last run, to notice resets.
+		bool               codeWriteFree;		// Whether the application was proven to never write into its code.
+
+		unsigned long long promotions;
+		unsigned long long demotions;
+		unsigned long long compiledCycles;
+		unsigned long long interpretedCycles;
+
+		unsigned int run(unsigned int cycles, bool frame);
+		unsigned int interpret(unsigned int cycles);			// Interprets up to the end of a block.
+		unsigned int execute(unsigned int block, unsigned int cycles);	// Executes a promoted block.
+		void promote(unsigned short address);
+		void demote(unsigned int block);
+		bool written(unsigned int address, unsigned int length);	// Demotes the blocks containing the written bytes. Returns whether there were any.
+
+		static bool endsBlock(unsigned short opcode);
+		static unsigned int writeSize(unsigned short opcode);
+		static Op predecode(unsigned short opcode);
+		static Op lower(const Chip8IrInst &inst, const Op &exact);	// Closure for an optimized IR instruction.
+
+		// Closures
+		template <void (Core::*Handler)()>
+		static void call(Core &c, const Op &) { (c.*Handler)(); }
+		static void decode(Core &c, const Op &op) { (c.*Core::decodeTable[op.opcode >> 12])(); }
+		static void jump(Core &c, const Op &op) { c.pc = op.nnn - 2; }
+		static void setToN(Core &c, const Op &op) { c.V[op.x] = op.nn; }
+		static void addN(Core &c, const Op &op) { c.V[op.x] += op.nn; }
+		static void assign(Core &c, const Op &op) { c.V[op.x] = c.V[op.y]; }
+		static void setI(Core &c, const Op &op) { c.I = op.nnn; }
+
+		// Closures for the IR passes
+		static void nop(Core &, const Op &) {}
+		static void load(Core &c, const Op &op) { c.V[0xF] = op.flag; c.V[op.x] = op.nn; }
+		static void bitwiseOr(Core &c, const Op &op) { c.V[op.x] |= c.V[op.y]; }
+		static void bitwiseAnd(Core &c, const Op &op) { c.V[op.x] &= c.V[op.y]; }
+		static void bitwiseXor(Core &c, const Op &op) { c.V[op.x] ^= c.V[op.y]; }
+		static void add(Core &c, const Op &op) { c.V[op.x] += c.V[op.y]; }
+		static void subtract(Core &c, const Op &op) { c.V[op.x] -= c.V[op.y]; }
+		static void reverseSubtract(Core &c, const Op &op) { c.V[op.x] = c.V[op.y] - c.V[op.x]; }
+		static void shiftRight(Core &c, const Op &op) { c.V[op.x] = c.V[op.y] >> 1; }
+		static void shiftLeft(Core &c, const Op &op) { c.V[op.x] = c.V[op.y] << 1; }
+		static void addToI(Core &c, const Op &op) { c.I += c.V[op.x]; }
+};
+
+// Instantiated in chip8_tiered.cpp
+extern template class Chip8Tiered<Chip8>;
+extern template class Chip8Tiered<Chip8Vip>;
+extern template class Chip8Tiered<Chip8SuperChip>;
+extern template class Chip8Tiered<Chip8XoChip>;
+
+#endif
@@ -0,0 +1,474 @@
+/**
+ *	@file	chip8_video.cpp
+ *	@author	Dejan Azinovic (dazinovic)
+ *	@date	18.10.2026
+ *
+ *	Contains an implementation of all methods from the chip8_video header.
+ *	Every kernel turns the pixels into two masks, one per plane (or per bit
+ *	of the color index), and picks the color of each pixel with bitwise
+ *	selects, so there are no branches and no table lookups per pixel.
+ */
+
+#include "chip8_video.h"
+#include "chip8_cpu.h"
+#include <cstdint>
+#include <cstring>
+
+#if defined(CHIP8_SIMD_X86)
+#include <immintrin.h>
+#endif
+
+// Kernels for one instruction set, indexed by pixel format
+struct Chip8VideoKernels {
+	const char *name;
+	void (*expandRow[2])(const unsigned char *plane0, const unsigned char *plane1, unsigned int width, const unsigned int *colors, void *destination);
+	void (*expandBytes[2])(const unsigned char *pixels, unsigned int width, const unsigned int *colors, void *destination);
+	void (*replicate[2])(const void *source, unsigned int width, void *destination, unsigned int scale);
+	void (*streamRows)(const void *row, size_t size, void *destination, size_t pitch, unsigned int count);
+};
+
+// Plain C++ kernels, also used for the pixels left over by the SIMD kernels
+template <class Pixel>
+static void expandRowScalar(const unsigned char *plane0, const unsigned char *plane1, unsigned int width, const unsigned int *colors, void *destination)
+{
+	Pixel *out = static_cast<Pixel *>(destination);
+	for (unsigned int x = 0; x < width; x++)
+	{
+		unsigned int shift = 7 - x % 8;
+		unsigned int index = (plane0[x / 8] >> shift) & 1;
+		if (plane1 != nullptr)
+		{
+			index |= ((plane1[x / 8] >> shift) & 1) << 1;
+		}
+		out[x] = static_cast<Pixel>(colors[index]);
+	}
+}
+
+template <class Pixel>
+static void expandBytesScalar(const unsigned char *pixels, unsigned int width, const unsigned int *colors, void *destination)
+{
+	Pixel *out = static_cast<Pixel *>(destination);
+	for (unsigned int x = 0; x < width; x++)
+	{
+		out[x] = static_cast<Pixel>(colors[pixels[x] & 3]);
+	}
+}
+
+// Repeats every pixel of a row scale times
+template <class Pixel>
+static void replicateScalar(const void *source, unsigned int width, void *destination, unsigned int scale)
+{
+	const Pixel *in = static_cast<const Pixel *>(source);
+	Pixel *out = static_cast<Pixel *>(destination);
+	for (unsigned int x = 0; x < width; x++)
+	{
+		for (unsigned int i = 0; i < scale; i++)
+		{
+			*out++ = in[x];
+		}
+	}
+}
+
+// Copies a row to count rows of the destination
+static void fillRowsScalar(const void *row, size_t size, void *destination, size_t pitch, unsigned int count)
+{
+	for (unsigned int i = 0; i < count; i++)
+	{
+		memcpy(static_cast<unsigned char *>(destination) + i * pitch, row, size);
+	}
+}
+
+#if defined(CHIP8_SIMD_X86)
+// Picks colors[mask1 * 2 + mask0] in every lane
+static __m128i selectSse2(__m128i mask0, __m128i mask1, const __m128i *colors)
+{
+	__m128i low = _mm_or_si128(_mm_and_si128(mask0, colors[1]), _mm_andnot_si128(mask0, colors[0]));
+	__m128i high = _mm_or_si128(_mm_and_si128(mask0, colors[3]), _mm_andnot_si128(mask0, colors[2]));
+	return _mm_or_si128(_mm_and_si128(mask1, high), _mm_andnot_si128(mask1, low));
+}
+
+// Writes eight pixels, given as 16-bit masks of both planes (or index bits)
+template <class Pixel>
+struct Sse2Pixels;
+
+template <>
+struct Sse2Pixels<unsigned int> {
+	__m128i colors[Chip8Video::MAX_COLORS];
+
+	Sse2Pixels(const unsigned int *palette)
+	{
+		for (unsigned int i = 0; i < Chip8Video::MAX_COLORS; i++)
+		{
+			colors[i] = _mm_set1_epi32(static_cast<int>(palette[i]));
+		}
+	}
+
+	void store(unsigned int *out, __m128i mask0, __m128i mask1) const
+	{
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(out), selectSse2(_mm_unpacklo_epi16(mask0, mask0), _mm_unpacklo_epi16(mask1, mask1), colors));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(out + 4), selectSse2(_mm_unpackhi_epi16(mask0, mask0), _mm_unpackhi_epi16(mask1, mask1), colors));
+	}
+};
+
+template <>
+struct Sse2Pixels<unsigned short> {
+	__m128i colors[Chip8Video::MAX_COLORS];
+
+	Sse2Pixels(const unsigned int *palette)
+	{
+		for (unsigned int i = 0; i < Chip8Video::MAX_COLORS; i++)
+		{
+			colors[i] = _mm_set1_epi16(static_cast<short>(palette[i]));
+		}
+	}
+
+	void store(unsigned short *out, __m128i mask0, __m128i mask1) const
+	{
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(out), selectSse2(mask0, mask1, colors));
+	}
+};
+
+// Spreads the bits of a packed byte over eight 16-bit lanes (all ones where set)
+static __m128i spreadSse2(unsigned char bits, __m128i lanes)
+{
+	return _mm_cmpeq_epi16(_mm_and_si128(_mm_set1_epi16(bits), lanes), lanes);
+}
+
+template <class Pixel>
+static void expandRowSse2(const unsigned char *plane0, const unsigned char *plane1, unsigned int width, const unsigned int *colors, void *destination)
+{
+	Sse2Pixels<Pixel> pixels(colors);
+	const __m128i lanes = _mm_setr_epi16(0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01);
+	Pixel *out = static_cast<Pixel *>(destination);
+	unsigned int x = 0;
+	for (; x + 8 <= width; x += 8)
+	{
+		__m128i mask0 = spreadSse2(plane0[x / 8], lanes);
+		__m128i mask1 = (plane1 != nullptr) ? spreadSse2(plane1[x / 8], lanes) : _mm_setzero_si128();
+		pixels.store(out + x, mask0, mask1);
+	}
+	expandRowScalar<Pixel>(plane0 + x / 8, (plane1 != nullptr) ? plane1 + x / 8 : nullptr, width - x, colors, out + x);
+}
+
+template <class Pixel>
+static void expandBytesSse2(const unsigned char *source, unsigned int width, const unsigned int *colors, void *destination)
+{
+	Sse2Pixels<Pixel> pixels(colors);
+	const __m128i one = _mm_set1_epi16(1);
+	const __m128i two = _mm_set1_epi16(2);
+	Pixel *out = static_cast<Pixel *>(destination);
+	unsigned int x = 0;
+	for (; x + 8 <= width; x += 8)
+	{
+		__m128i index = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(source + x)), _mm_setzero_si128());
+		pixels.store(out + x, _mm_cmpeq_epi16(_mm_and_si128(index, one), one), _mm_cmpeq_epi16(_mm_and_si128(index, two), two));
+	}
+	expandBytesScalar<Pixel>(source + x, width - x, colors, out + x);
+}
+
+// Broadcasts every pixel and covers its run with whole vectors, the last one
+// overlapping the one before instead of running past the end of the run.
+// Runs shorter than a vector are left to the scalar kernel.
+template <class Pixel>
+static void replicateSse2(const void *source, unsigned int width, void *destination, unsigned int scale)
+{
+	const unsigned int LANES = 16 / sizeof(Pixel);
+	if (scale < LANES)
+	{
+		replicateScalar<Pixel>(source, width, destination, scale);
+		return;
+	}
+
+	const Pixel *in = static_cast<const Pixel *>(source);
+	Pixel *out = static_cast<Pixel *>(destination);
+	for (unsigned int x = 0; x < width; x++, out += scale)
+	{
+		__m128i pixel = (sizeof(Pixel) == 4) ? _mm_set1_epi32(static_cast<int>(in[x])) : _mm_set1_epi16(static_cast<short>(in[x]));
+		for (unsigned int i = 0; i + LANES < scale; i += LANES)
+		{
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), pixel);
+		}
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(out + scale - LANES), pixel);
+	}
+}
+
+// Copies a row to count rows of the destination with non-temporal stores.
+// The bytes before the first and after the last 16-byte boundary of a row
+// go through the cache.
+static void streamRowsSse2(const void *row, size_t size, void *destination, size_t pitch, unsigned int count)
+{
+	const unsigned char *in = static_cast<const unsigned char *>(row);
+	for (unsigned int i = 0; i < count; i++)
+	{
+		unsigned char *out = static_cast<unsigned char *>(destination) + i * pitch;
+		size_t offset = (16 - reinterpret_cast<uintptr_t>(out) % 16) % 16;
+		if (offset > size)
+		{
+			offset = size;
+		}
+		memcpy(out, in, offset);
+		for (; offset + 16 <= size; offset += 16)
+		{
+			_mm_stream_si128(reinterpret_cast<__m128i *>(out + offset), _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + offset)));
+		}
+		memcpy(out + offset, in + offset, size - offset);
+	}
+	_mm_sfence();
+}
+
+// The same kernels with 16 pixels per step. They are compiled for AVX2
+// regardless of the build settings and only called on CPUs that have it.
+// The upper halves of the registers are cleared before handing the rest of
+// a row to the SSE2 kernels, which would stall on them otherwise.
+template <class Pixel>
+struct Avx2Pixels;
+
+template <>
+struct Avx2Pixels<unsigned int> {
+	__m256i colors[Chip8Video::MAX_COLORS];
+
+	CHIP8_TARGET_AVX2 Avx2Pixels(const unsigned int *palette)
+	{
+		for (unsigned int i = 0; i < Chip8Video::MAX_COLORS; i++)
+		{
+			colors[i] = _mm256_set1_epi32(static_cast<int>(palette[i]));
+		}
+	}
+
+	// Eight pixels, given as 16-bit masks
+	CHIP8_TARGET_AVX2 void storeHalf(unsigned int *out, __m128i mask0, __m128i mask1) const
+	{
+		__m256i wide0 = _mm256_cvtepi16_epi32(mask0);
+		__m256i wide1 = _mm256_cvtepi16_epi32(mask1);
+		__m256i low = _mm256_blendv_epi8(colors[0], colors[1], wide0);
+		__m256i high = _mm256_blendv_epi8(colors[2], colors[3], wide0);
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(out), _mm256_blendv_epi8(low, high, wide1));
+	}
+
+	CHIP8_TARGET_AVX2 void store(unsigned int *out, __m256i mask0, __m256i mask1) const
+	{
+		storeHalf(out, _mm256_castsi256_si128(mask0), _mm256_castsi256_si128(mask1));
+		storeHalf(out + 8, _mm256_extracti128_si256(mask0, 1), _mm256_extracti128_si256(mask1, 1));
+	}
+};
+
+template <>
+struct Avx2Pixels<unsigned short> {
+	__m256i colors[Chip8Video::MAX_COLORS];
+
+	CHIP8_TARGET_AVX2 Avx2Pixels(const unsigned int *palette)
+	{
+		for (unsigned int i = 0; i < Chip8Video::MAX_COLORS; i++)
+		{
+			colors[i] = _mm256_set1_epi16(static_cast<short>(palette[i]));
+		}
+	}
+
+	CHIP8_TARGET_AVX2 void store(unsigned short *out, __m256i mask0, __m256i mask1) const
+	{
+		__m256i low = _mm256_blendv_epi8(colors[0], colors[1], mask0);
+		__m256i high = _mm256_blendv_epi8(colors[2], colors[3], mask0);
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(out), _mm256_blendv_epi8(low, high, mask1));
+	}
+};
+
+// Spreads the bits of two packed bytes over sixteen 16-bit lanes
+CHIP8_TARGET_AVX2 static __m256i spreadAvx2(const unsigned char *bits, __m256i lanes)
+{
+	return _mm256_cmpeq_epi16(_mm256_and_si256(_mm256_set1_epi16(static_cast<short>(bits[0] << 8 | bits[1])), lanes), lanes);
+}
+
+template <class Pixel>
+CHIP8_TARGET_AVX2 static void expandRowAvx2(const unsigned char *plane0, const unsigned char *plane1, unsigned int width, const unsigned int *colors, void *destination)
+{
+	Avx2Pixels<Pixel> pixels(colors);
+	const __m256i lanes = _mm256_setr_epi16(
+		static_cast<short>(0x8000), 0x4000, 0x2000, 0x1000, 0x0800, 0x0400, 0x0200, 0x0100,
+		0x0080, 0x0040, 0x0020, 0x0010, 0x0008, 0x0004, 0x0002, 0x0001);
+	Pixel *out = static_cast<Pixel *>(destination);
+	unsigned int x = 0;
+	for (; x + 16 <= width; x += 16)
+	{
+		__m256i mask0 = spreadAvx2(plane0 + x / 8, lanes);
+		__m256i mask1 = (plane1 != nullptr) ? spreadAvx2(plane1 + x / 8, lanes) : _mm256_setzero_si256();
+		pixels.store(out + x, mask0, mask1);
+	}
+	_mm256_zeroupper();
+	expandRowSse2<Pixel>(plane0 + x / 8, (plane1 != nullptr) ? plane1 + x / 8 : nullptr, width - x, colors, out + x);
+}
+
+template <class Pixel>
+CHIP8_TARGET_AVX2 static void expandBytesAvx2(const unsigned char *source, unsigned int width, const unsigned int *colors, void *destination)
+{
+	Avx2Pixels<Pixel> pixels(colors);
+	const __m256i one = _mm256_set1_epi16(1);
+	const __m256i two = _mm256_set1_epi16(2);
+	Pixel *out = static_cast<Pixel *>(destination);
+	unsigned int x = 0;
+	for (; x + 16 <= width; x += 16)
+	{
+		__m256i index = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(source + x)));
+		pixels.store(out + x, _mm256_cmpeq_epi16(_mm256_and_si256(index, one), one), _mm256_cmpeq_epi16(_mm256_and_si256(index, two), two));
+	}
+	_mm256_zeroupper();
+	expandBytesSse2<Pixel>(source + x, width - x, colors, out + x);
+}
+
+template <class Pixel>
+CHIP8_TARGET_AVX2 static void replicateAvx2(const void *source, unsigned int width, void *destination, unsigned int scale)
+{
+	const unsigned int LANES = 32 / sizeof(Pixel);
+	if (scale < LANES)
+	{
+		replicateSse2<Pixel>(source, width, destination, scale);
+		return;
+	}
+
+	const Pixel *in = static_cast<const Pixel *>(source);
+	Pixel *out = static_cast<Pixel *>(destination);
+	for (unsigned int x = 0; x < width; x++, out += scale)
+	{
+		__m256i pixel = (sizeof(Pixel) == 4) ? _mm256_set1_epi32(static_cast<int>(in[x])) : _mm256_set1_epi16(static_cast<short>(in[x]));
+		for (unsigned int i = 0; i + LANES < scale; i += LANES)
+		{
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), pixel);
+		}
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(out + scale - LANES), pixel);
+	}
+}
+#endif
+
+// Picks the kernels for the instruction set selected by Chip8Cpu. There are
+// no AVX-512 kernels, a row of the screen is too short to gain from them.
+static const Chip8VideoKernels *selectKernels()
+{
+	static const Chip8VideoKernels scalar = { "scalar",
+		{ expandRowScalar<unsigned int>, expandRowScalar<unsigned short> },
+		{ expandBytesScalar<unsigned int>, expandBytesScalar<unsigned short> },
+		{ replicateScalar<unsigned int>, replicateScalar<unsigned short> },
+		fillRowsScalar };
+#if defined(CHIP8_SIMD_X86)
+	static const Chip8VideoKernels sse2 = { "sse2",
+		{ expandRowSse2<unsigned int>, expandRowSse2<unsigned short> },
+		{ expandBytesSse2<unsigned int>, expandBytesSse2<unsigned short> },
+		{ replicateSse2<unsigned int>, replicateSse2<unsigned short> },
+		streamRowsSse2 };
+	static const Chip8VideoKernels avx2 = { "avx2",
+		{ expandRowAvx2<unsigned int>, expandRowAvx2<unsigned short> },
+		{ expandBytesAvx2<unsigned int>, expandBytesAvx2<unsigned short> },
+		{ replicateAvx2<unsigned int>, replicateAvx2<unsigned short> },
+		streamRowsSse2 };
+	switch (Chip8Cpu::GetSimd())
+	{
+	case Chip8Simd::Scalar:	return &scalar;
+	case Chip8Simd::Sse2:	return &sse2;
+	default:				return &avx2;
+	}
+#else
+	return &scalar;
+#endif
+}
+
+// Initializes the converter with the palette
+Chip8Video::Chip8Video(Chip8PixelFormat format, const unsigned int *palette, unsigned int colorCount)
+	: format(format), kernels(selectKernels())
+{
+	// Indices past the end of a short palette repeat its colors
+	for (unsigned int i = 0; i < MAX_COLORS; i++)
+	{
+		unsigned int color = palette[i % colorCount];
+		unsigned int red = (color >> 16) & 0xFF;
+		unsigned int green = (color >> 8) & 0xFF;
+		unsigned int blue = color & 0xFF;
+		if (format == Chip8PixelFormat::Rgba8888)
+		{
+			// Little-endian words, so the bytes are red, green, blue, alpha
+			colors[i] = red | green << 8 | blue << 16 | 0xFF000000;
+		}
+		else
+		{
+			colors[i] = (red >> 3) << 11 | (green >> 2) << 5 | blue >> 3;
+		}
+	}
+}
+
+// Converts one row of packed pixels, width / 8 bytes per plane
+void Chip8Video::ExpandRow(const unsigned char *plane0, const unsigned char *plane1, unsigned int width, void *destination, unsigned int scale) const
+{
+	unsigned int kernel = static_cast<unsigned int>(format);
+	if (scale == 1)
+	{
+		kernels->expandRow[kernel](plane0, plane1, width, colors, destination);
+		return;
+	}
+
+	// Convert a chunk at a time into a buffer, then repeat its pixels
+	const static unsigned int CHUNK = 128;
+	unsigned int buffer[CHUNK];
+	for (unsigned int x = 0; x < width; x += CHUNK)
+	{
+		unsigned int count = (width - x < CHUNK) ? width - x : CHUNK;
+		kernels->expandRow[kernel](plane0 + x / 8, (plane1 != nullptr) ? plane1 + x / 8 : nullptr, count, colors, buffer);
+		kernels->replicate[kernel](buffer, count, static_cast<unsigned char *>(destination) + x * scale * GetPixelSize(), scale);
+	}
+}
+
+// Converts one row of byte pixels
+void Chip8Video::ExpandBytes(const unsigned char *pixels, unsigned int width, void *destination, unsigned int scale) const
+{
+	unsigned int kernel = static_cast<unsigned int>(format);
+	if (scale == 1)
+	{
+		kernels->expandBytes[kernel](pixels, width, colors, destination);
+		return;
+	}
+
+	const static unsigned int CHUNK = 128;
+	unsigned int buffer[CHUNK];
+	for (unsigned int x = 0; x < width; x += CHUNK)
+	{
+		unsigned int count = (width - x < CHUNK) ? width - x : CHUNK;
+		kernels->expandBytes[kernel](pixels + x, count, colors, buffer);
+		kernels->replicate[kernel](buffer, count, static_cast<unsigned char *>(destination) + x * scale * GetPixelSize(), scale);
+	}
+}
+
+// Returns the name of the instruction set the kernels use
+const char *Chip8Video::GetKernelName() const
+{
+	return kernels->name;
+}
+
+// Converts a screen of byte pixels and repeats every row scale times
+void Chip8Video::ExpandFrame(const unsigned char *pixels, unsigned int width, unsigned int height, void *destination, size_t pitch, unsigned int scale) const
+{
+	if (scale == 1)
+	{
+		for (unsigned int y = 0; y < height; y++)
+		{
+			ExpandBytes(pixels + y * width, width, static_cast<unsigned char *>(destination) + y * pitch);
+		}
+		return;
+	}
+
+	std::vector<unsigned char> row(width * scale * GetPixelSize());
+	bool stream = height * scale * pitch >= STREAM_SIZE;
+	for (unsigned int y = 0; y < height; y++)
+	{
+		ExpandBytes(pixels + y * width, width, row.data(), scale);
+		fillRows(row.data(), row.size(), static_cast<unsigned char *>(destination) + y * scale * pitch, pitch, scale, stream);
+	}
+}
+
+// Copies a row to count rows of the destination, past the cache if asked to
+void Chip8Video::fillRows(const void *row, size_t size, void *destination, size_t pitch, unsigned int count, bool stream) const
+{
+	if (stream)
+	{
+		kernels->streamRows(row, size, destination, pitch, count);
+	}
+	else
+	{
+		fillRowsScalar(row, size, destination, pitch, count);
+	}
+}
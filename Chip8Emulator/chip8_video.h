@@ -0,0 +1,86 @@
+/**
+ *	@file	chip8_video.h
+ *	@author	Dejan Azinovic (dazinovic)
+ *	@date	18.10.2026
+ *
+ *	Header file for the Chip8Video class, which converts Chip-8 screens into
+ *	true color pixels for textures, screenshots and video streams. A screen
+ *	row is either packed (one bit per pixel and plane, as returned by
+ *	GetScreenRow) or one byte per pixel (as in Chip8Lockstep). Either way
+ *	every pixel picks one of up to four palette colors, and the result is
+ *	written as RGBA8888 or RGB565, optionally scaled up by an integer factor.
+ *
+ *	The kernels are bound by Chip8Cpu (chip8_cpu.h) when a converter is
+ *	created: AVX2 or SSE2 on x86 CPUs, plain C++ elsewhere.
+ *
+ *	Scaled screens are meant for headless export (thumbnails, videos) and
+ *	can be written straight into a Chip8MappedFile (chip8_mapped.h). Every
+ *	scaled row is built once in a buffer and then copied to its rows of the
+ *	destination, so the destination is never read. Large frames are written
+ *	with streaming stores that bypass the cache.
+ */
+
+#ifndef CHIP8_VIDEO
+#define CHIP8_VIDEO
+
+#include <cstddef>
+#include <vector>
+
+enum class Chip8PixelFormat : unsigned char {
+	Rgba8888,		// Four bytes per pixel: red, green, blue and alpha (always 255).
+	Rgb565			// One 16-bit word per pixel: 5 bits red, 6 bits green, 5 bits blue.
+};
+
+struct Chip8VideoKernels;
+
+class Chip8Video {
+	public:
+		Chip8Video(Chip8PixelFormat format, const unsigned int *palette, unsigned int colorCount = MAX_COLORS);	// Colors are given as 0xRRGGBB.
+
+		const static unsigned int MAX_COLORS = 4;	// One color per combination of the two planes.
+
+		void ExpandRow(const unsigned char *plane0, const unsigned char *plane1, unsigned int width, void *destination, unsigned int scale = 1) const;	// Converts one packed row (plane1 may be null).
+		void ExpandBytes(const unsigned char *pixels, unsigned int width, void *destination, unsigned int scale = 1) const;	// Converts one row of byte pixels (color index in the low two bits).
+		template <class Screen>
+		void ExpandScreen(const Screen &screen, void *destination, size_t pitch, unsigned int scale = 1) const;	// Converts the screen of a core or machine.
+		void ExpandFrame(const unsigned char *pixels, unsigned int width, unsigned int height, void *destination, size_t pitch, unsigned int scale = 1) const;	// Converts a screen of byte pixels (as in Chip8Lockstep).
+
+		Chip8PixelFormat GetFormat() const { return format; }
+		unsigned int GetPixelSize() const { return (format == Chip8PixelFormat::Rgba8888) ? 4 : 2; }	// Bytes per pixel.
+		const char *GetKernelName() const;	// Instruction set the conversion runs with.
+
+	private:
+		const static size_t STREAM_SIZE = 512 * 1024;	// Frames from this size on are written past the cache.
+
+		Chip8PixelFormat format;
+		unsigned int     colors[MAX_COLORS];	// Palette in the pixel format.
+		const Chip8VideoKernels *kernels;	// Kernels for the instruction set of the CPU.
+
+		void fillRows(const void *row, size_t size, void *destination, size_t pitch, unsigned int count, bool stream) const;	// Copies a row to count rows of the destination.
+};
+
+// Converts every row of the screen and repeats it scale times
+template <class Screen>
+void Chip8Video::ExpandScreen(const Screen &screen, void *destination, size_t pitch, unsigned int scale) const
+{
+	unsigned int width = screen.GetScreenWidth();
+	unsigned int height = screen.GetScreenHeight();
+	if (scale == 1)
+	{
+		for (unsigned int y = 0; y < height; y++)
+		{
+			ExpandRow(screen.GetScreenRow(y, 0), screen.GetScreenRow(y, 1), width, static_cast<unsigned char *>(destination) + y * pitch);
+		}
+		return;
+	}
+
+	std::vector<unsigned char> row(width * scale * GetPixelSize());
+	bool stream = height * scale * pitch >= STREAM_SIZE;
+	for (unsigned int y = 0; y < height; y++)
+	{
+		ExpandRow(screen.GetScreenRow(y, 0), screen.GetScreenRow(y, 1), width, row.data(), scale);
+		fillRows(row.data(), row.size(), static_cast<unsigned char *>(destination) + y * scale * pitch, pitch, scale, stream);
+	}
+}
+
+#endif
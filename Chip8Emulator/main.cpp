@@ -8,9 +8,25 @@
  *	by pressing P. Emulation speed can be changed with the plus and minus
  *	keys (dependant on platform and keyboard layout).
  *
+ *	The emulator runs one frame per 60 Hz host frame, and the screen is
+ *	rendered once per frame, no matter how many cycles the frame has.
+ *
  *	Command line usage:
  *
- *	> Chip8Emulator Chip8Application
+ *	> Chip8Emulator [--platform chip8|vip|schip|xochip] Chip8Application [Sound.wav [Video.gif|Video.y4m]]
+ *
+ *	The sound of the application is recorded into Sound.wav if it is given,
+ *	and played on the sound device otherwise.
+ *	The emulated frames are recorded into Video.gif or Video.y4m if it is
+ *	given, at four times the size of the high resolution screen.
+ *	The platform selects the quirks of the emulator. Without it, applications
+ *	with the extension .sc8 run as SUPER-CHIP and applications with the
+ *	extension .xo8 as XO-CHIP applications.
+ *
+ *	To translate an application ahead of time into a C++ source file
+ *	instead of running it:
+ *
+ *	> Chip8Emulator --recompile Chip8Application Output.cpp Name
  *
  */
 
@@ -19,16 +35,23 @@
 #include <vector>
 #include <thread>
 #include <chrono>
+#include <memory>
 
 #include <GL\glew.h>
 #include <GLFW\glfw3.h>
 
 #include "chip8.h"
+#include "chip8_audio.h"
+#include "chip8_events.h"
+#include "chip8_machine.h"
+#include "chip8_recompiler.h"
+#include "chip8_recorder.h"
+#include "chip8_video.h"
 
 // Function prototypes
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode);
 void resize_callback(GLFWwindow* window, int width, int height);
-void change_sleep_time(GLFWwindow* window, int newSleepTime);
+void change_speed(GLFWwindow* window, double newSpeed);
 void process_input();
 
 // Window dimensions
@@ -36,25 +59,137 @@ GLuint windowWidth  = 800;
 GLuint windowHeight = 600;
 
 // Timing
-int sleepTime = 16;
+double speed = 1.0;		// Emulated cycles per frame (one cycle per frame runs at the original speed).
+const std::chrono::steady_clock::duration frameLength = std::chrono::microseconds(16667);
 
 // Input
 unsigned char keys[1024];
 
 // Emulator
-Chip8 emulator;
+std::unique_ptr<Chip8Machine> emulator;
+Chip8EventQueue events;
+Chip8EventLogger logger(events, std::cout);
+
+// Sound
+std::unique_ptr<Chip8AudioBackend> audioBackend;
+std::unique_ptr<Chip8Audio> audio;
 
 int main(int argc, char** argv)
 {
 	if (argc < 2)
 	{
-		std::cout << "Usage: Chip8Emulator Chip8Application" << std::endl << std::endl;
+		std::cout << "Usage: Chip8Emulator [--platform chip8|vip|schip|xochip] Chip8Application [Sound.wav [Video.gif|Video.y4m]]" << std::endl << std::endl;
 		return -1;
 	}
 
+	// Translate the game instead of running it
+	if (std::string(argv[1]) == "--recompile")
+	{
+		Chip8Recompiler recompiler;
+		recompiler.SetEventSink(&events);
+		logger.Start();
+		bool translated = argc >= 5 && recompiler.LoadApplication(argv[2]) && recompiler.Translate(argv[3], argv[4]);
+		logger.Stop();
+		if (!translated)
+		{
+			std::cout << "Usage: Chip8Emulator --recompile Chip8Application Output.cpp Name" << std::endl << std::endl;
+			return -1;
+		}
+		return 0;
+	}
+
+	// Select the platform by name or by the extension of the application
+	Chip8Platform platform = Chip8Platform::Default;
+	int first = 1;
+	if (std::string(argv[1]) == "--platform")
+	{
+		if (argc < 4 || !Chip8Machine::ParsePlatform(argv[2], platform))
+		{
+			std::cout << "Usage: Chip8Emulator [--platform chip8|vip|schip|xochip] Chip8Application [Sound.wav [Video.gif|Video.y4m]]" << std::endl << std::endl;
+			return -1;
+		}
+		first = 3;
+	}
+	else
+	{
+		std::string filename(argv[1]);
+		std::string extension = (filename.size() > 4) ? filename.substr(filename.size() - 4) : "";
+		if (extension == ".sc8")
+		{
+			platform = Chip8Platform::SuperChip;
+		}
+		else if (extension == ".xo8")
+		{
+			platform = Chip8Platform::XoChip;
+		}
+	}
+	emulator = Chip8Machine::Create(platform);
+
+	// Synthesize the sound of the emulator into a file or onto the sound
+	// device, at speed cycles per 60 Hz frame
+	if (argc > first + 1)
+	{
+		audioBackend.reset(new Chip8WavBackend(argv[first + 1]));
+	}
+	else
+	{
+#if defined(_WIN32)
+		audioBackend.reset(new Chip8WaveOutBackend());
+#else
+		audioBackend.reset(new Chip8NullBackend());
+#endif
+	}
+	audio.reset(new Chip8Audio(*audioBackend, 44100, (unsigned int)(60 * speed)));
+	if (!audio->Start())
+	{
+		if (argc > first + 1)
+		{
+			std::cerr << "Failed to open the sound file" << std::endl;
+			return -1;
+		}
+
+		// Run silently without a sound device
+		audio.reset();
+		audioBackend.reset(new Chip8NullBackend());
+		audio.reset(new Chip8Audio(*audioBackend, 44100, (unsigned int)(60 * speed)));
+		audio->Start();
+	}
+
+	// Record the emulated frames on a thread of their own
+	const unsigned int palette[4] = { 0x000000, 0xFFFFFF, 0xAAAAAA, 0x555555 };
+	std::unique_ptr<Chip8FrameEncoder> videoEncoder;
+	std::unique_ptr<Chip8Recorder> recorder;
+	if (argc > first + 2)
+	{
+		std::string filename(argv[first + 2]);
+		if (filename.size() > 4 && filename.substr(filename.size() - 4) == ".y4m")
+		{
+			videoEncoder.reset(new Chip8Y4mEncoder(filename, palette));
+		}
+		else
+		{
+			videoEncoder.reset(new Chip8GifEncoder(filename, palette));
+		}
+		recorder.reset(new Chip8Recorder(*videoEncoder, 4));
+		if (!recorder->Start())
+		{
+			std::cerr << "Failed to open the video file" << std::endl;
+			return -1;
+		}
+	}
+
+	// Log the events of the emulator on a thread of its own and pass them
+	// on to the audio
+	Chip8EventFanout sinks;
+	sinks.Add(&events);
+	sinks.Add(audio.get());
+	emulator->SetEventSink(&sinks);
+	logger.Start();
+
 	// Load game
-	if (!emulator.LoadApplication(argv[1]))
+	if (!emulator->LoadApplication(argv[first]))
 	{
+		logger.Stop();
 		return -1;
 	}
 
@@ -99,15 +234,17 @@ int main(int argc, char** argv)
 	// Vsync
 	glfwSwapInterval(1);
 
-	// Screen data
-	std::vector<unsigned char> screen(3 * emulator.SCREEN_WIDTH * emulator.SCREEN_HEIGHT);
+	// Screen data in the colors of the four plane combinations (black and
+	// white for plain Chip-8 applications)
+	Chip8Video video(Chip8PixelFormat::Rgba8888, palette);
+	std::vector<unsigned char> screen(4 * Chip8::SCREEN_WIDTH * Chip8::SCREEN_HEIGHT);
 
 	// The texture we're going to render to
 	GLuint textureId;
 	glGenTextures(1, &textureId);
 	glBindTexture(GL_TEXTURE_2D, textureId);
 
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, emulator.SCREEN_WIDTH, emulator.SCREEN_HEIGHT, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, Chip8::SCREEN_WIDTH, Chip8::SCREEN_HEIGHT, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
 
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
@@ -124,29 +261,37 @@ int main(int argc, char** argv)
 	glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
 
 	// Create main loop
+	double cycleBudget = 0.0;
+	std::chrono::steady_clock::time_point nextFrame = std::chrono::steady_clock::now();
 	while (!glfwWindowShouldClose(window))
 	{
-		// Emulate one cycle
-		emulator.EmulateCycle();
-
-		// Copy the black & white emulator screen into the RGB screen
-		for (int i = 0; i < emulator.SCREEN_WIDTH * emulator.SCREEN_HEIGHT; i++)
+		// Emulate one frame. Below full speed, frames without a whole cycle
+		// just show the screen again.
+		cycleBudget += speed;
+		unsigned int cycles = (unsigned int)cycleBudget;
+		cycleBudget -= cycles;
+		emulator->RunFrame(cycles);
+		audio->Advance(emulator->GetCycleCount());
+		if (recorder)
 		{
-			unsigned char pixelIntensity = (emulator.screen[i] == 0) ? 0 : 255;
-			screen[3 * i] = pixelIntensity;
-			screen[3 * i + 1] = pixelIntensity;
-			screen[3 * i + 2] = pixelIntensity;
+			recorder->Capture(*emulator, cycles);
 		}
 
+		// Combine the planes of the emulator screen into the RGBA screen in
+		// one pass. The color of a pixel has one bit per plane.
+		unsigned int width = emulator->GetScreenWidth();
+		unsigned int height = emulator->GetScreenHeight();
+		video.ExpandScreen(*emulator, screen.data(), 4 * width);
+
 		// Draw the screen data into the framebuffer
 		glClear(GL_COLOR_BUFFER_BIT);
 
 		glBindTexture(GL_TEXTURE_2D, textureId);
-		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, emulator.SCREEN_WIDTH, emulator.SCREEN_HEIGHT, GL_RGB, GL_UNSIGNED_BYTE, screen.data());
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, screen.data());
 		glBindTexture(GL_TEXTURE_2D, 0);
 
 		glBindFramebuffer(GL_READ_FRAMEBUFFER, framebufferId);
-		glBlitFramebuffer(0, emulator.SCREEN_HEIGHT, emulator.SCREEN_WIDTH, 0,
+		glBlitFramebuffer(0, height, width, 0,
 						  0, 0, windowWidth, windowHeight,
 						  GL_COLOR_BUFFER_BIT, GL_NEAREST);
 		glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
@@ -154,8 +299,9 @@ int main(int argc, char** argv)
 		// Swap buffers
 		glfwSwapBuffers(window);
 
-		// Allow other processes to run
-		std::this_thread::sleep_for(std::chrono::milliseconds(sleepTime));
+		// Wait for the next frame
+		nextFrame += frameLength;
+		std::this_thread::sleep_until(nextFrame);
 
 		// Check for input
 		glfwPollEvents();
@@ -165,6 +311,12 @@ int main(int argc, char** argv)
 	// Clean up resources
 	glfwDestroyWindow(window);
 	glfwTerminate();
+	audio->Stop();
+	if (recorder)
+	{
+		recorder->Stop();
+	}
+	logger.Stop();
 
 	return 0;
 }
@@ -182,17 +334,18 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 	// Change emulation speed
 	if (key == GLFW_KEY_EQUAL && action == GLFW_PRESS) // Plus
 	{
-		change_sleep_time(window, sleepTime / 2);
+		change_speed(window, speed * 2);
 	}
 	else if (key == GLFW_KEY_SLASH && action == GLFW_PRESS) // Minus
 	{
-		change_sleep_time(window, sleepTime * 2);
+		change_speed(window, speed / 2);
 	}
 
 	// Toggle sound
 	if (key == GLFW_KEY_P && action == GLFW_PRESS)
 	{
-		emulator.ToggleSound();
+		audio->ToggleSound();
+		logger.ToggleSound();
 	}
 
 	// Register which keys are currently pressed
@@ -213,27 +366,30 @@ void resize_callback(GLFWwindow * window, int width, int height)
 	windowHeight = height;
 }
 
-// Changes the sleep time to the provided sleep time while ensuring that it
-// doesn't go out of bounds. Also sets the appropriate window title.
-void change_sleep_time(GLFWwindow* window, int newSleepTime)
+// Changes the speed to the provided speed while ensuring that it doesn't go
+// out of bounds. Also sets the appropriate window title.
+void change_speed(GLFWwindow* window, double newSpeed)
 {
-	if (newSleepTime == 0)
+	if (newSpeed < 0.25)
 	{
-		sleepTime = 1;
+		speed = 0.25;
 	}
-	else if (newSleepTime >= 64)
+	else if (newSpeed > 1024.0)
 	{
-		sleepTime = 64;
+		speed = 1024.0;
 	}
 	else
 	{
-		sleepTime = newSleepTime;
+		speed = newSpeed;
 	}
 
+	// Keep the sound in step with the emulation
+	audio->SetCycleRate((unsigned int)(60 * speed));
+
 	// Set window title
-	if (sleepTime != 16)
+	if (speed != 1.0)
 	{
-		std::string number = std::to_string(16.0 / sleepTime);
+		std::string number = std::to_string(speed);
 		while (number[number.length() - 1] == '0' || number[number.length() - 1] == '.')
 		{
 			number = number.substr(0, number.length() - 1);
@@ -250,20 +406,21 @@ void change_sleep_time(GLFWwindow* window, int newSleepTime)
 // Set the appropriate emulator keys
 void process_input()
 {
-	emulator.keys[0x0] = keys[GLFW_KEY_0];
-	emulator.keys[0x1] = keys[GLFW_KEY_1];
-	emulator.keys[0x2] = keys[GLFW_KEY_2];
-	emulator.keys[0x3] = keys[GLFW_KEY_3];
-	emulator.keys[0x4] = keys[GLFW_KEY_4];
-	emulator.keys[0x5] = keys[GLFW_KEY_5];
-	emulator.keys[0x6] = keys[GLFW_KEY_6];
-	emulator.keys[0x7] = keys[GLFW_KEY_7];
-	emulator.keys[0x8] = keys[GLFW_KEY_8];
-	emulator.keys[0x9] = keys[GLFW_KEY_9];
-	emulator.keys[0xA] = keys[GLFW_KEY_A];
-	emulator.keys[0xB] = keys[GLFW_KEY_B];
-	emulator.keys[0xC] = keys[GLFW_KEY_C];
-	emulator.keys[0xD] = keys[GLFW_KEY_D];
-	emulator.keys[0xE] = keys[GLFW_KEY_E];
-	emulator.keys[0xF] = keys[GLFW_KEY_F];
+	unsigned char *emulatorKeys = emulator->GetKeys();
+	emulatorKeys[0x0] = keys[GLFW_KEY_0];
+	emulatorKeys[0x1] = keys[GLFW_KEY_1];
+	emulatorKeys[0x2] = keys[GLFW_KEY_2];
+	emulatorKeys[0x3] = keys[GLFW_KEY_3];
+	emulatorKeys[0x4] = keys[GLFW_KEY_4];
+	emulatorKeys[0x5] = keys[GLFW_KEY_5];
+	emulatorKeys[0x6] = keys[GLFW_KEY_6];
+	emulatorKeys[0x7] = keys[GLFW_KEY_7];
+	emulatorKeys[0x8] = keys[GLFW_KEY_8];
+	emulatorKeys[0x9] = keys[GLFW_KEY_9];
+	emulatorKeys[0xA] = keys[GLFW_KEY_A];
+	emulatorKeys[0xB] = keys[GLFW_KEY_B];
+	emulatorKeys[0xC] = keys[GLFW_KEY_C];
+	emulatorKeys[0xD] = keys[GLFW_KEY_D];
+	emulatorKeys[0xE] = keys[GLFW_KEY_E];
+	emulatorKeys[0xF] = keys[GLFW_KEY_F];
 }
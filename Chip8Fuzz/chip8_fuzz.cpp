@@ -0,0 +1,125 @@
+/**
+ *	@file	chip8_fuzz.cpp
+ *	@author	Dejan Azinovic (dazinovic)
+ *	@date	18.10.2026
+ *
+ *	Fuzzing target for the Chip8Core class template. Every input is loaded as
+ *	an application straight from memory and run for a bounded number of
+ *	cycles. The first byte of an input picks the core: its low bits choose
+ *	one of the instantiations of chip8.cpp (the default quirks with the
+ *	wrapping, clamping or trapping access policy, or one of the other quirk
+ *	profiles with wrapping access), and its top bit enables the XO-CHIP
+ *	extensions with their 64k memory. The raw access policy is left out, as
+ *	bad applications are undefined behaviour there. The next two bytes are
+ *	the key state held down during the run (one bit per key), the rest is
+ *	the application. One emulator per core is reused for all inputs and
+ *	reset in between, which only swaps a few shared pages back in.
+ *
+ *	Crashes are reported by the sanitizers the target is built with. Built
+ *	with libFuzzer, the fuzzer drives the target in-process:
+ *
+ *		> clang++ -std=c++14 -g -O1 -fsanitize=fuzzer,address,undefined
+ *		          -I../Chip8Emulator chip8_fuzz.cpp ../Chip8Emulator/chip8.cpp
+ *
+ *	Built with CHIP8_FUZZ_STANDALONE defined, the target runs the files given
+ *	on the command line instead, or loops over inputs from stdin in AFL++
+ *	persistent mode when compiled with afl-clang-fast. The Chip8Fuzz and
+ *	Chip8LockstepFuzz projects of the solution build the standalone runners,
+ *	for replaying crashing inputs under the Visual Studio debugger.
+ */
+
+#include "chip8.h"
+#include <cstddef>
+#include <cstdint>
+
+#ifdef CHIP8_FUZZ_STANDALONE
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+#endif
+
+const static unsigned int FUZZ_CYCLES = 10000;	// Cycle budget per input.
+
+// Runs an input (without the byte that picked the core) on one core
+template <class Core>
+static void run(Core &chip8, bool xoChip, const uint8_t *data, size_t size)
+{
+	chip8.SetXoChip(xoChip);
+	if (!chip8.LoadApplication(data + 2, size - 2))
+	{
+		return;
+	}
+
+	unsigned short keyState = data[0] << 8 | data[1];
+	for (unsigned int key = 0; key < 16; key++)
+	{
+		chip8.keys[key] = (keyState >> key) & 1;
+	}
+
+	// Stops early at faults
+	chip8.Run(FUZZ_CYCLES);
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	static Chip8 chip8;
+	static Chip8Core<Chip8ClampAccess> clamp;
+	static Chip8Core<Chip8TrapAccess> trap;
+	static Chip8Vip vip;
+	static Chip8SuperChip superChip;
+	static Chip8XoChip xoChip;
+
+	if (size < 3)
+	{
+		return 0;
+	}
+
+	bool extensions = (data[0] & 0x80) != 0;
+	switch ((data[0] & 0x7F) % 6)
+	{
+	case 0: run(chip8, extensions, data + 1, size - 1);		break;
+	case 1: run(clamp, extensions, data + 1, size - 1);		break;
+	case 2: run(trap, extensions, data + 1, size - 1);		break;
+	case 3: run(vip, extensions, data + 1, size - 1);		break;
+	case 4: run(superChip, extensions, data + 1, size - 1);	break;
+	case 5: run(xoChip, extensions, data + 1, size - 1);	break;
+	}
+
+	return 0;
+}
+
+#ifdef CHIP8_FUZZ_STANDALONE
+#ifdef __AFL_LOOP
+__AFL_FUZZ_INIT();
+#endif
+
+int main(int argc, char **argv)
+{
+#ifdef __AFL_LOOP
+	(void)argc;
+	(void)argv;
+
+	unsigned char *buffer = __AFL_FUZZ_TESTCASE_BUF;
+	while (__AFL_LOOP(10000))
+	{
+		LLVMFuzzerTestOneInput(buffer, __AFL_FUZZ_TESTCASE_LEN);
+	}
+#else
+	for (int i = 1; i < argc; i++)
+	{
+		std::ifstream in(argv[i], std::ios::in | std::ios::binary);
+		if (!in.good())
+		{
+			std::cerr << "Error opening input file " << argv[i] << "." << std::endl;
+			return -1;
+		}
+
+		std::vector<unsigned char> input((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+		LLVMFuzzerTestOneInput(input.data(), input.size());
+	}
+#endif
+
+	return 0;
+}
+#endif
@@ -0,0 +1,167 @@
+/**
+ *	@file	chip8_lockstep_fuzz.cpp
+ *	@author	Dejan Azinovic (dazinovic)
+ *	@date	18.10.2026
+ *
+ *	Differential fuzzing target for the Chip8Lockstep class. Every input is
+ *	run on the lanes of a lockstep engine and on one Chip8 per lane, and the
+ *	target aborts as soon as a lane ends up with another memory, screen or
+ *	fault than its Chip8. The only exception is a lane stopped by 00FF, which
+ *	the lockstep engine doesn't implement: its Chip8 stops as well once it
+ *	switched to the 128x64 screen, and the lane isn't compared.
+ *
+ *	The first byte of an input limits the SIMD kernels (0 to 3 for scalar to
+ *	AVX-512), the second one seeds rand, and the next two are a key state
+ *	(one bit per key) that every lane holds down rotated by its lane number,
+ *	so that the lanes diverge on key checks. The rest is the application.
+ *	The Chip8s are stepped one cycle at a time in lane order, which is the
+ *	order the lanes draw their random numbers in.
+ *
+ *	Built like chip8_fuzz.cpp, with the lockstep engine added:
+ *
+ *		> clang++ -std=c++14 -g -O1 -fsanitize=fuzzer,address,undefined
+ *		          -I../Chip8Emulator chip8_lockstep_fuzz.cpp ../Chip8Emulator/chip8.cpp
+ *		          ../Chip8Emulator/chip8_lockstep.cpp ../Chip8Emulator/chip8_cpu.cpp
+ */
+
+#include "chip8.h"
+#include "chip8_lockstep.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+#ifdef CHIP8_FUZZ_STANDALONE
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+#endif
+
+const static unsigned int FUZZ_CYCLES = 1000;	// Cycle budget per input.
+const static unsigned int FUZZ_LANES  = 70;		// More than one lane group, so the padding lanes run too.
+
+// Whether a lane ended up like the Chip8 that ran the same input
+static bool matches(Chip8Lockstep &lockstep, unsigned int lane, const Chip8 &chip8)
+{
+	Chip8Fault fault = lockstep.GetFault(lane);
+	if (fault != chip8.GetFault() || (fault != Chip8Fault::None && lockstep.GetFaultPc(lane) != chip8.GetFaultPc()))
+	{
+		return false;
+	}
+
+	for (unsigned int address = 0; address < 4096; address++)
+	{
+		if (lockstep.ReadMemory(lane, address) != chip8.ReadMemory(address))
+		{
+			return false;
+		}
+	}
+
+	for (unsigned int y = 0; y < Chip8Lockstep::SCREEN_HEIGHT; y++)
+	{
+		for (unsigned int x = 0; x < Chip8Lockstep::SCREEN_WIDTH; x++)
+		{
+			if (lockstep.GetPixel(lane, x, y) != chip8.GetPixel(x, y))
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	static Chip8 chip8[FUZZ_LANES];
+
+	if (size < 4)
+	{
+		return 0;
+	}
+
+	Chip8Cpu::LimitSimd(static_cast<Chip8Simd>(data[0] & 0x03));
+	Chip8Lockstep lockstep(FUZZ_LANES);
+	if (!lockstep.LoadApplication(data + 4, size - 4))
+	{
+		return 0;
+	}
+
+	unsigned short keyState = data[2] << 8 | data[3];
+	for (unsigned int lane = 0; lane < FUZZ_LANES; lane++)
+	{
+		unsigned int shift = lane % 16;
+		unsigned short laneKeys = (unsigned short)(keyState << shift | keyState >> (16 - shift));
+
+		chip8[lane].Reset();
+		chip8[lane].LoadApplication(data + 4, size - 4);
+		for (unsigned int key = 0; key < 16; key++)
+		{
+			chip8[lane].keys[key] = (laneKeys >> key) & 1;
+			lockstep.GetKeys(lane)[key] = (laneKeys >> key) & 1;
+		}
+	}
+
+	srand(data[1]);
+	lockstep.Run(FUZZ_CYCLES);
+
+	// A Chip8 on the 128x64 screen left the instructions the lanes run, and
+	// must not draw the random numbers of the lanes after it
+	bool highResolution[FUZZ_LANES] = {};
+	srand(data[1]);
+	for (unsigned int cycle = 0; cycle < FUZZ_CYCLES; cycle++)
+	{
+		for (unsigned int lane = 0; lane < FUZZ_LANES; lane++)
+		{
+			if (!highResolution[lane])
+			{
+				chip8[lane].EmulateCycle();
+				highResolution[lane] = chip8[lane].GetScreenWidth() > Chip8Lockstep::SCREEN_WIDTH;
+			}
+		}
+	}
+
+	for (unsigned int lane = 0; lane < FUZZ_LANES; lane++)
+	{
+		if (!highResolution[lane] && !matches(lockstep, lane, chip8[lane]))
+		{
+			abort();
+		}
+	}
+
+	return 0;
+}
+
+#ifdef CHIP8_FUZZ_STANDALONE
+#ifdef __AFL_LOOP
+__AFL_FUZZ_INIT();
+#endif
+
+int main(int argc, char **argv)
+{
+#ifdef __AFL_LOOP
+	(void)argc;
+	(void)argv;
+
+	unsigned char *buffer = __AFL_FUZZ_TESTCASE_BUF;
+	while (__AFL_LOOP(10000))
+	{
+		LLVMFuzzerTestOneInput(buffer, __AFL_FUZZ_TESTCASE_LEN);
+	}
+#else
+	for (int i = 1; i < argc; i++)
+	{
+		std::ifstream in(argv[i], std::ios::in | std::ios::binary);
+		if (!in.good())
+		{
+			std::cerr << "Error opening input file " << argv[i] << "." << std::endl;
+			return -1;
+		}
+
+		std::vector<unsigned char> input((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+		LLVMFuzzerTestOneInput(input.data(), input.size());
+	}
+#endif
+
+	return 0;
+}
+#endif